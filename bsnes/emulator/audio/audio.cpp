@@ -36,35 +36,41 @@ auto Audio::createStream(uint channels, double frequency) -> shared_pointer<Stre
   return stream;
 }
 
+//mixes every frame that all streams have ready, and hands them to the platform in blocks
 auto Audio::process() -> void {
   while(_streams) {
+    uint frames = Block;
     for(auto& stream : _streams) {
-      if(!stream->pending()) return;
+      frames = min(frames, stream->pending());
     }
+    if(!frames) return;
 
-    double samples[_channels];
-    for(auto& sample : samples) sample = 0.0;
+    double block[frames * _channels];
+    for(uint frame : range(frames)) {
+      auto samples = block + frame * _channels;
+      for(auto c : range(_channels)) samples[c] = 0.0;
 
-    for(auto& stream : _streams) {
-      double buffer[_channels];
-      uint length = stream->read(buffer), offset = 0;
+      for(auto& stream : _streams) {
+        double buffer[_channels];
+        uint length = stream->read(buffer), offset = 0;
 
-      for(auto& sample : samples) {
-        sample += buffer[offset];
-        if(++offset >= length) offset = 0;
+        for(auto c : range(_channels)) {
+          samples[c] += buffer[offset];
+          if(++offset >= length) offset = 0;
+        }
       }
-    }
 
-    for(auto c : range(_channels)) {
-      samples[c] = max(-1.0, min(+1.0, samples[c] * _volume));
-    }
+      for(auto c : range(_channels)) {
+        samples[c] = max(-1.0, min(+1.0, samples[c] * _volume));
+      }
 
-    if(_channels == 2) {
-      if(_balance < 0.0) samples[1] *= 1.0 + _balance;
-      if(_balance > 0.0) samples[0] *= 1.0 - _balance;
+      if(_channels == 2) {
+        if(_balance < 0.0) samples[1] *= 1.0 + _balance;
+        if(_balance > 0.0) samples[0] *= 1.0 - _balance;
+      }
     }
 
-    platform->audioFrame(samples, _channels);
+    platform->audioFrames(block, _channels, frames);
   }
 }
 
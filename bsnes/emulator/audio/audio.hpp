@@ -14,6 +14,8 @@ struct Stream;
 
 struct Audio {
   ~Audio();
+  static constexpr uint Block = 256;  //frames processed at once by the batched paths
+
   auto reset(Interface* interface) -> void;
 
   inline auto channels() const -> uint { return _channels; }
@@ -66,6 +68,7 @@ struct Stream {
   auto pending() const -> uint;
   auto read(double samples[]) -> uint;
   auto write(const double samples[]) -> void;
+  auto write(const int16 samples[], uint frames) -> void;
 
   template<typename... P> auto sample(P&&... p) -> void {
     double samples[sizeof...(P)] = {forward<P>(p)...};
@@ -116,6 +116,36 @@ auto Stream::write(const double samples[]) -> void {
   audio.process();
 }
 
+//interleaved 16-bit frames: each filter runs over a whole block at a time,
+//which yields the same results as write() on one frame after another.
+auto Stream::write(const int16 samples[], uint frames) -> void {
+  uint count = channels.size();
+  double block[Audio::Block];
+  while(frames) {
+    uint length = min(frames, Audio::Block);
+    for(auto c : range(count)) {
+      for(uint n : range(length)) {
+        block[n] = samples[n * count + c] / 32768.0 + 1e-25;  //constant offset used to suppress denormals
+      }
+      for(auto& filter : channels[c].filters) {
+        switch(filter.mode) {
+        case Filter::Mode::DCRemoval: for(uint n : range(length)) block[n] = filter.dcRemoval.process(block[n]); break;
+        case Filter::Mode::OnePole: for(uint n : range(length)) block[n] = filter.onePole.process(block[n]); break;
+        case Filter::Mode::Biquad: for(uint n : range(length)) block[n] = filter.biquad.process(block[n]); break;
+        }
+      }
+      for(auto& filter : channels[c].nyquist) {
+        for(uint n : range(length)) block[n] = filter.process(block[n]);
+      }
+      auto& resampler = channels[c].resampler;
+      for(uint n : range(length)) resampler.write(block[n]);
+    }
+    samples += length * count;
+    frames -= length;
+    audio.process();
+  }
+}
+
 auto Stream::serialize(serializer& s) -> void {
   for(auto& channel : channels) {
     channel.resampler.serialize(s);
@@ -2,6 +2,10 @@
 
 namespace Emulator {
 
+//codes are indexed by address, as find() is called on every memory read:
+//a bitmap of the low 16 address bits rejects most addresses without a code,
+//and a hash table leads to the codes of the others, chained in the order they were appended.
+
 struct Cheat {
   struct Code {
     auto operator==(const Code& code) const -> bool {
@@ -25,10 +29,15 @@ struct Cheat {
 
   auto reset() -> void {
     codes.reset();
+    chain.reset();
+    table.reset();
+    for(auto& word : filter) word = 0;
   }
 
   auto append(uint address, uint data, maybe<uint> compare = {}) -> void {
     codes.append({address, data, compare});
+    chain.append(Empty);
+    index(codes.size() - 1);
   }
 
   auto assign(const vector<string>& list) -> void {
@@ -43,15 +52,78 @@ struct Cheat {
   }
 
   auto find(uint address, uint compare) -> maybe<uint> {
-    for(auto& code : codes) {
-      if(code.address == address && (!code.compare || code.compare() == compare)) {
-        return code.data;
-      }
+    if(!(filter[address >> 6 & 1023] >> (address & 63) & 1)) return nothing;
+    for(uint code = lookup(address).first; code != Empty; code = chain[code]) {
+      if(!codes[code].compare || codes[code].compare() == compare) return codes[code].data;
     }
     return nothing;
   }
 
+  auto contains(const Code& code) const -> bool {
+    for(uint n = lookup(code.address).first; n != Empty; n = chain[n]) {
+      if(codes[n] == code) return true;
+    }
+    return false;
+  }
+
   vector<Code> codes;
+
+private:
+  enum : uint { Empty = ~0u };
+
+  struct Slot {
+    uint address = 0;
+    uint first = Empty;  //the first and last codes at the address
+    uint last = Empty;
+  };
+
+  alwaysinline auto slot(uint address) const -> uint {
+    return (address * 0x9e3779b1u) & (table.size() - 1);  //the table size is a power of two
+  }
+
+  auto lookup(uint address) const -> const Slot& {
+    static const Slot none;
+    if(!table) return none;
+    for(uint n = slot(address);; n = n + 1 & table.size() - 1) {
+      if(table[n].first == Empty || table[n].address == address) return table[n];
+    }
+  }
+
+  //adds the code to the index, growing the table to keep it at most half full
+  auto index(uint code) -> void {
+    uint address = codes[code].address;
+    filter[address >> 6 & 1023] |= 1ull << (address & 63);
+
+    if(table.size() < codes.size() * 2) {
+      uint size = 16;
+      while(size < codes.size() * 2) size <<= 1;
+      table.reset();
+      table.resize(size);
+      for(auto& link : chain) link = Empty;
+      for(uint n : range(code)) insert(n);
+    }
+    insert(code);
+  }
+
+  auto insert(uint code) -> void {
+    uint address = codes[code].address;
+    for(uint n = slot(address);; n = n + 1 & table.size() - 1) {
+      auto& entry = table[n];
+      if(entry.first == Empty) {
+        entry = {address, code, code};
+        return;
+      }
+      if(entry.address == address) {
+        chain[entry.last] = code;
+        entry.last = code;
+        return;
+      }
+    }
+  }
+
+  vector<uint> chain;  //the next code at the same address
+  vector<Slot> table;
+  uint64_t filter[1024] = {};
 };
 
 }
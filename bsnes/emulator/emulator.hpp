@@ -37,7 +37,7 @@ namespace Emulator {
   static const string Website   = "https://github.com/DerKoun/bsnes-hd";
 
   //incremented only when serialization format changes
-  static const string SerializerVersion = "114.2";
+  static const string SerializerVersion = "114.3";
 
   namespace Constants {
     namespace Colorburst {
@@ -80,9 +80,28 @@ struct Interface {
   virtual auto rtc() -> bool { return false; }
   virtual auto synchronize(uint64 timestamp = 0) -> void {}
 
+  //profiling functions
+  //time spent rendering the previous frame, in nanoseconds (where rendering is separate from emulation)
+  virtual auto frameRenderTime() -> uint64_t { return 0; }
+  //time spent building the memory map of the loaded game, including power cycles, in nanoseconds
+  virtual auto memoryMapTime() -> uint64_t { return 0; }
+  //rows of tile data read by the renderer, and decoded after VRAM writes (where the renderer caches decoded tiles)
+  virtual auto tileCacheReads() -> uint64_t { return 0; }
+  virtual auto tileCacheDecodes() -> uint64_t { return 0; }
+  //scheduler profile: switches between the emulated threads, their cycles and host time, in total and per frame.
+  //enabling (or disabling) the profiler discards the previous profile
+  virtual auto setProfiling(bool enable) -> void {}
+  virtual auto profileJSON() -> string { return {}; }
+  virtual auto profileTrace() -> string { return {}; }  //in the Chrome trace event format
+
   //state functions
+  virtual auto serializeSize(bool synchronize = true) -> uint { return 0; }
   virtual auto serialize(bool synchronize = true) -> serializer { return {}; }
   virtual auto unserialize(serializer&) -> bool { return false; }
+  //incremental state functions: reuse an existing buffer, only transferring memory that changed
+  virtual auto serialize(serializer&, bool synchronize, bool incremental) -> bool { return false; }
+  virtual auto unserialize(serializer&, bool incremental) -> bool { return false; }
+  virtual auto trackDirtyPages(bool enable) -> void {}
 
   //cheat functions
   virtual auto read(uint24 address) -> uint8 { return 0; }
@@ -13,11 +13,26 @@ struct Platform {
     string option;
   };
 
+  //frontend-owned memory that a video frame can be rendered into directly, which avoids copying it.
+  //only the rows [top, top + height) of the frame are displayed, and thus stored.
+  struct VideoTarget {
+    explicit operator bool() const { return data; }
+
+    uint32* data = nullptr;
+    uint pitch = 0;  //in pixels
+    uint top = 0;
+    uint height = 0;
+  };
+
   virtual auto path(uint id) -> string { return ""; }
   virtual auto open(uint id, string name, vfs::file::mode mode, bool required = false) -> shared_pointer<vfs::file> { return {}; }
   virtual auto load(uint id, string name, string type, vector<string> options = {}) -> Load { return {}; }
+  virtual auto videoTarget(uint width, uint height, uint scale) -> VideoTarget { return {}; }
   virtual auto videoFrame(const uint32* data, uint pitch, uint width, uint height, uint scale) -> void {}
   virtual auto audioFrame(const double* samples, uint channels) -> void {}
+  virtual auto audioFrames(const double* samples, uint channels, uint frames) -> void {
+    for(uint frame : range(frames)) audioFrame(samples + frame * channels, channels);
+  }
   virtual auto inputPoll(uint port, uint device, uint input) -> int16 { return 0; }
   virtual auto inputRumble(uint port, uint device, uint input, bool enable) -> void {}
   virtual auto dipSettings(Markup::Node node) -> uint { return 0; }
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <condition_variable>
+#include <thread>
+
+namespace Emulator {
+
+//persistent helper threads for splitting per-frame work across cores.
+//run() hands out [0, count) in batches: every participant starts on its own contiguous share,
+//and steals batches from the other shares once its own is exhausted.
+//the calling thread participates in run() and wait(), so a pool of size zero simply runs the work inline.
+
+struct WorkerPool {
+  static constexpr uint Limit = 63;
+
+  using Work = function<void (uint begin, uint end)>;
+
+  ~WorkerPool() {
+    resize(0);
+  }
+
+  auto size() const -> uint {
+    return count;
+  }
+
+  //number of helper threads to use when none is requested explicitly
+  static auto automatic() -> uint {
+    uint cores = std::thread::hardware_concurrency();
+    return cores > 1 ? min(cores - 1, Limit) : 0;
+  }
+
+  auto resize(uint size, bool pin = true) -> void {
+    size = min(size, Limit);
+    if(size == count && pin == pinned) return;
+    wait();
+
+    if(count) {
+      { std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+      }
+      wake.notify_all();
+      for(uint index : range(count)) threads[index].join();
+      count = 0;
+      quit = false;
+    }
+
+    pinned = pin;
+    for(uint index : range(size)) {
+      threads[index] = std::thread([=, seen = generation] { worker(index + 1, seen); });
+    }
+    count = size;
+  }
+
+  auto run(uint count, uint batch, const Work& work) -> void {
+    start(count, batch, work);
+    wait();
+  }
+
+  //begins running work in the background; it must be completed with wait()
+  //before the pool is used again, and before anything the work reads is modified.
+  auto start(uint count, uint batch, const Work& work) -> void {
+    wait();
+    batch = max(1u, batch);
+    if(!this->count || count <= batch) return work(0, count);
+
+    participants = min(this->count + 1, (count + batch - 1) / batch);
+    uint share = (count + participants - 1) / participants;
+    share = (share + batch - 1) / batch * batch;
+    for(uint index : range(participants)) {
+      shares[index].next = min(index * share, count);
+      shares[index].end = min(index * share + share, count);
+    }
+
+    { std::lock_guard<std::mutex> lock(mutex);
+      job = work;
+      this->batch = batch;
+      pending = this->count;
+      generation++;
+    }
+    wake.notify_all();
+    active = true;
+  }
+
+  //the calling thread helps out with any work that has not been picked up yet
+  auto wait() -> void {
+    if(!active) return;
+    process(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return pending == 0; });
+    job.reset();
+    active = false;
+  }
+
+  auto busy() const -> bool {
+    return active;
+  }
+
+private:
+  auto worker(uint index, uint seen) -> void {
+    if(pinned) pin(index);
+    while(true) {
+      { std::unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [&] { return quit || generation != seen; });
+        if(quit) return;
+        seen = generation;
+      }
+      //threads beyond the number of participants for this run have nothing to do
+      if(index < participants) process(index);
+      { std::lock_guard<std::mutex> lock(mutex);
+        if(--pending == 0) done.notify_one();
+      }
+    }
+  }
+
+  auto process(uint self) -> void {
+    for(uint n : range(participants)) {
+      auto& share = shares[(self + n) % participants];
+      while(true) {
+        uint begin = share.next.fetch_add(batch);
+        if(begin >= share.end) break;
+        job(begin, min(begin + batch, share.end));
+      }
+    }
+  }
+
+  //helper threads are bound to distinct cores, skipping the first one
+  static auto pin(uint index) -> void {
+    uint cores = std::thread::hardware_concurrency();
+    if(cores < 2) return;
+    #if defined(PLATFORM_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % cores, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    #elif defined(PLATFORM_WINDOWS)
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << (index % cores));
+    #endif
+  }
+
+  struct alignas(64) Share {
+    std::atomic<uint> next{0};
+    uint end = 0;
+  };
+
+  std::thread threads[Limit];
+  uint count = 0;
+  Share shares[Limit + 1];
+  Work job;
+  bool active = false;
+  uint batch = 1;
+  uint participants = 0;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  uint generation = 0;
+  uint pending = 0;
+  bool quit = false;
+  bool pinned = true;
+};
+
+}
@@ -29,7 +29,7 @@ struct ARM7TDMI {
   //registers.cpp
   struct GPR;
   struct PSR;
-  inline auto r(uint4) -> GPR&;
+  alwaysinline auto r(uint4) -> GPR&;
   inline auto cpsr() -> PSR&;
   inline auto spsr() -> PSR&;
   inline auto privileged() const -> bool;
@@ -52,7 +52,7 @@ struct ARM7TDMI {
   auto ROR(uint32, uint8) -> uint32;
   auto RRX(uint32) -> uint32;
   auto SUB(uint32, uint32, bool) -> uint32;
-  auto TST(uint4) -> bool;
+  alwaysinline auto TST(uint4) -> bool;
 
   //instruction.cpp
   auto fetch() -> void;
@@ -226,7 +226,9 @@ struct ARM7TDMI {
   boolean carry;
   boolean irq;
 
-  function<auto (uint32 opcode) -> void> armInstruction[4096];
+  //called directly rather than through function<>: this dispatch runs once per ARM instruction
+  using ArmHandler = auto (*)(ARM7TDMI&, uint32 opcode) -> void;
+  ArmHandler armInstruction[4096] = {};
   function<auto () -> void> thumbInstruction[65536];
 
   //disassembler.cpp
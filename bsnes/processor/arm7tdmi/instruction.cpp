@@ -40,7 +40,7 @@ auto ARM7TDMI::instruction() -> void {
   if(!pipeline.execute.thumb) {
     if(!TST(opcode >> 28)) return;
     uint12 index = (opcode & 0x0ff00000) >> 16 | (opcode & 0x000000f0) >> 4;
-    armInstruction[index](opcode);
+    armInstruction[index](*this, opcode);
   } else {
     thumbInstruction[(uint16)opcode]();
   }
@@ -61,7 +61,7 @@ auto ARM7TDMI::armInitialize() -> void {
   #define bind(id, name, ...) { \
     uint index = (id & 0x0ff00000) >> 16 | (id & 0x000000f0) >> 4; \
     assert(!armInstruction[index]); \
-    armInstruction[index] = [&](uint32 opcode) { return armInstruction##name(arguments); }; \
+    armInstruction[index] = [](ARM7TDMI& self, uint32 opcode) { return self.armInstruction##name(arguments); }; \
     armDisassemble[index] = [&](uint32 opcode) { return armDisassemble##name(arguments); }; \
   }
 
@@ -135,7 +135,15 @@ auto Cartridge::loadMap(Markup::Node map, T& memory) -> uint {
   auto mask = map["mask"].natural();
   if(size == 0) size = memory.size();
   if(size == 0) return print("loadMap(): size=0\n"), 0;  //does this ever actually occur?
-  return bus.map({&T::read, &memory}, {&T::write, &memory}, addr, size, base, mask);
+  uint id = bus.map({&T::read, &memory}, {&T::write, &memory}, addr, size, base, mask);
+  //derived types may intercept accesses, so only the plain memory types are accessed directly
+  if constexpr(is_same_v<T, ReadableMemory> || is_same_v<T, ProtectableMemory>) {
+    bus.direct(id, memory.data(), memory.size());
+  }
+  if constexpr(is_same_v<T, WritableMemory>) {
+    bus.direct(id, memory.data(), memory.size(), &memory.dirty);
+  }
+  return id;
 }
 
 auto Cartridge::loadMap(
@@ -1,3 +1,3 @@
 auto Cartridge::serialize(serializer& s) -> void {
-  s.array(ram.data(), ram.size());
+  ram.dirty.serialize(s, ram.data(), ram.size());
 }
@@ -1,5 +1,5 @@
 auto MCC::serialize(serializer& s) -> void {
-  s.array(psram.data(), psram.size());
+  psram.dirty.serialize(s, psram.data(), psram.size());
 
   s.integer(irq.flag);
   s.integer(irq.enable);
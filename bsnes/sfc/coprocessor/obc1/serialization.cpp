@@ -1,5 +1,5 @@
 auto OBC1::serialize(serializer& s) -> void {
-  s.array(ram.data(), ram.size());
+  ram.dirty.serialize(s, ram.data(), ram.size());
 
   s.integer(status.address);
   s.integer(status.baseptr);
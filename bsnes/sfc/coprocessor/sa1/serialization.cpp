@@ -2,8 +2,8 @@ auto SA1::serialize(serializer& s) -> void {
   WDC65816::serialize(s);
   Thread::serialize(s);
 
-  s.array(iram.data(), iram.size());
-  s.array(bwram.data(), bwram.size());
+  iram.dirty.serialize(s, iram.data(), iram.size());
+  bwram.dirty.serialize(s, bwram.data(), bwram.size());
   s.integer(bwram.dma);
 
   //sa1.hpp
@@ -1,6 +1,6 @@
 auto SPC7110::serialize(serializer& s) -> void {
   Thread::serialize(s);
-  s.array(ram.data(), ram.size());
+  ram.dirty.serialize(s, ram.data(), ram.size());
 
   s.integer(r4801);
   s.integer(r4802);
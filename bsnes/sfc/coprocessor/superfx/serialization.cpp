@@ -2,5 +2,5 @@ auto SuperFX::serialize(serializer& s) -> void {
   GSU::serialize(s);
   Thread::serialize(s);
 
-  s.array(ram.data(), ram.size());
+  ram.dirty.serialize(s, ram.data(), ram.size());
 }
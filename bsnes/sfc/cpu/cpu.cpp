@@ -77,8 +77,8 @@ auto CPU::power(bool reset) -> void {
 
   reader = {&CPU::readRAM, this};
   writer = {&CPU::writeRAM, this};
-  bus.map(reader, writer, "00-3f,80-bf:0000-1fff", 0x2000);
-  bus.map(reader, writer, "7e-7f:0000-ffff", 0x20000);
+  bus.direct(bus.map(reader, writer, "00-3f,80-bf:0000-1fff", 0x2000), wram, sizeof(wram), &wramDirty);
+  bus.direct(bus.map(reader, writer, "7e-7f:0000-ffff", 0x20000), wram, sizeof(wram), &wramDirty);
 
   reader = {&CPU::readAPU, this};
   writer = {&CPU::writeAPU, this};
@@ -102,6 +102,7 @@ auto CPU::power(bool reset) -> void {
       for(auto& byte : wram) byte = 0xff;
     }
   }
+  wramDirty.markAll();
 
   for(uint n : range(8)) {
     channels[n] = {};
@@ -69,6 +69,7 @@ struct CPU : Processor::WDC65816, Thread, PPUcounter {
   auto serialize(serializer&) -> void;
 
   uint8 wram[128 * 1024];
+  DirtyPages wramDirty{128 * 1024};
   vector<Thread*> coprocessors;
 
   struct Overclocking {
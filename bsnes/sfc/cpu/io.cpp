@@ -97,6 +97,7 @@ auto CPU::readDMA(uint addr, uint8 data) -> uint8 {
 
 auto CPU::writeRAM(uint addr, uint8 data) -> void {
   wram[addr] = data;
+  wramDirty.mark(addr);
 }
 
 auto CPU::writeAPU(uint addr, uint8 data) -> void {
@@ -3,7 +3,7 @@ auto CPU::serialize(serializer& s) -> void {
   Thread::serialize(s);
   PPUcounter::serialize(s);
 
-  s.array(wram);
+  wramDirty.serialize(s, wram, sizeof(wram));
 
   s.integer(version);
 
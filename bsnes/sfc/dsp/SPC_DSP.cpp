@@ -735,7 +735,11 @@ ECHO_CLOCK( 28 )
 inline void SPC_DSP::echo_write( int ch )
 {
 	if ( !(m.t_echo_enabled & 0x20) )
+	{
 		SET_LE16A( ECHO_PTR( ch ), m.t_echo_out [ch] );
+		if ( m.echo == m.ram )
+			dsp.apuramDirty.mark( m.t_echo_ptr + ch * 2 );
+	}
 	m.t_echo_out [ch] = 0;
 }
 ECHO_CLOCK( 29 )
@@ -16,14 +16,16 @@ auto DSP::main() -> void {
     clock += 2 * 32;
   }
 
+  //samples are handed to the audio stream in blocks, rather than one frame at a time
+  if(spc_dsp.sample_count() >= Block * 2) flush();
+}
+
+//also called at the end of every frame, and before serialization:
+//samples never cross a frame or run-ahead boundary, or a state load.
+auto DSP::flush() -> void {
   int count = spc_dsp.sample_count();
   if(count > 0) {
-    if(!system.runAhead)
-    for(uint n = 0; n < count; n += 2) {
-      float left  = samplebuffer[n + 0] / 32768.0f;
-      float right = samplebuffer[n + 1] / 32768.0f;
-      stream->sample(left, right);
-    }
+    if(!system.runAhead) stream->write(samplebuffer, count / 2);
     spc_dsp.set_output(samplebuffer, 8192);
   }
 }
@@ -63,6 +65,7 @@ auto DSP::power(bool reset) -> void {
     spc_dsp.soft_reset();
     spc_dsp.set_output(samplebuffer, 8192);
   }
+  apuramDirty.markAll();
 
   if(configuration.hacks.hotfixes) {
     //Magical Drop (Japan) does not initialize the DSP registers at startup:
@@ -3,8 +3,12 @@
 struct DSP {
   shared_pointer<Emulator::Stream> stream;
   uint8 apuram[64 * 1024] = {};
+  DirtyPages apuramDirty{64 * 1024};
+
+  static constexpr uint Block = 128;  //stereo frames
 
   auto main() -> void;
+  auto flush() -> void;
   auto read(uint8 address) -> uint8;
   auto write(uint8 address, uint8 data) -> void;
 
@@ -9,7 +9,8 @@ static auto dsp_state_load(unsigned char** in, void* out, size_t size) -> void {
 }
 
 auto DSP::serialize(serializer& s) -> void {
-  s.array(apuram);
+  flush();
+  apuramDirty.serialize(s, apuram, sizeof(apuram));
   s.array(samplebuffer);
   s.integer(clock);
 
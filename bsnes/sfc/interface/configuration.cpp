@@ -30,6 +30,9 @@ auto Configuration::process(Markup::Node document, bool load) -> void {
   bind(boolean, "Hacks/PPU/Fast", hacks.ppu.fast);
   bind(boolean, "Hacks/PPU/Deinterlace", hacks.ppu.deinterlace);
   bind(natural, "Hacks/PPU/RenderCycle", hacks.ppu.renderCycle);
+  bind(natural, "Hacks/PPU/RenderThreads", hacks.ppu.renderThreads);
+  bind(boolean, "Hacks/PPU/RenderPipeline", hacks.ppu.renderPipeline);
+  bind(boolean, "Hacks/PPU/RenderIncremental", hacks.ppu.renderIncremental);
   bind(boolean, "Hacks/PPU/NoSpriteLimit", hacks.ppu.noSpriteLimit);
   bind(boolean, "Hacks/PPU/NoVRAMBlocking", hacks.ppu.noVRAMBlocking);
   bind(natural, "Hacks/PPU/Mode7/Scale", hacks.ppu.mode7.scale);
@@ -46,6 +46,9 @@ struct Configuration {
       bool noSpriteLimit = true;
       bool noVRAMBlocking = false;
       uint renderCycle = 512;
+      uint renderThreads = 0;  //0 = one per core
+      bool renderPipeline = false;
+      bool renderIncremental = false;
       struct Mode7 {
         uint scale = 2;
         uint perspective = 1;
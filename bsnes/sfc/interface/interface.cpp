@@ -239,6 +239,38 @@ auto Interface::synchronize(uint64 timestamp) -> void {
   if(cartridge.has.SharpRTC) sharprtc.synchronize(timestamp);
 }
 
+auto Interface::frameRenderTime() -> uint64_t {
+  return system.fastPPU() ? ppufast.lastRenderTime : 0;
+}
+
+auto Interface::memoryMapTime() -> uint64_t {
+  return bus.mapTime;
+}
+
+auto Interface::tileCacheReads() -> uint64_t {
+  return system.fastPPU() ? ppufast.tileCache.reads : 0;
+}
+
+auto Interface::tileCacheDecodes() -> uint64_t {
+  return system.fastPPU() ? ppufast.tileCache.decodes : 0;
+}
+
+auto Interface::setProfiling(bool enable) -> void {
+  profiler.enable(enable);
+}
+
+auto Interface::profileJSON() -> string {
+  return profiler.json();
+}
+
+auto Interface::profileTrace() -> string {
+  return profiler.trace();
+}
+
+auto Interface::serializeSize(bool synchronize) -> uint {
+  return system.serializeSize(synchronize);
+}
+
 auto Interface::serialize(bool synchronize) -> serializer {
   return system.serialize(synchronize);
 }
@@ -247,6 +279,18 @@ auto Interface::unserialize(serializer& s) -> bool {
   return system.unserialize(s);
 }
 
+auto Interface::serialize(serializer& s, bool synchronize, bool incremental) -> bool {
+  return system.serialize(s, synchronize, incremental);
+}
+
+auto Interface::unserialize(serializer& s, bool incremental) -> bool {
+  return system.unserialize(s, incremental);
+}
+
+auto Interface::trackDirtyPages(bool enable) -> void {
+  system.trackDirtyPages(enable);
+}
+
 auto Interface::read(uint24 address) -> uint8 {
   return cpu.readDisassembler(address);
 }
@@ -266,14 +310,7 @@ auto Interface::cheats(const vector<string>& list) -> void {
 
   //determine all old codes to remove
   for(auto& oldCode : oldCheat.codes) {
-    bool found = false;
-    for(auto& newCode : newCheat.codes) {
-      if(oldCode == newCode) {
-        found = true;
-        break;
-      }
-    }
-    if(!found) {
+    if(!newCheat.contains(oldCode)) {
       //remove old cheat
       if(oldCode.enable) {
         bus.write(oldCode.address, oldCode.restore);
@@ -283,14 +320,7 @@ auto Interface::cheats(const vector<string>& list) -> void {
 
   //determine all new codes to create
   for(auto& newCode : newCheat.codes) {
-    bool found = false;
-    for(auto& oldCode : oldCheat.codes) {
-      if(newCode == oldCode) {
-        found = true;
-        break;
-      }
-    }
-    if(!found) {
+    if(!oldCheat.contains(newCode)) {
       //create new cheat
       newCode.restore = bus.read(newCode.address);
       if(!newCode.compare || newCode.compare() == newCode.restore) {
@@ -303,6 +333,7 @@ auto Interface::cheats(const vector<string>& list) -> void {
   }
 
   cheat = newCheat;
+  system.compileCheats();
 
   //restore ROM write protection
   Memory::GlobalWriteEnable = false;
@@ -316,11 +347,14 @@ auto Interface::configuration(string name) -> string {
   return SuperFamicom::configuration.read(name);
 }
 
+//a pipelined render in progress reads the configuration, so it is completed first
 auto Interface::configure(string configuration) -> bool {
+  ppufast.renderWait();
   return SuperFamicom::configuration.write(configuration);
 }
 
 auto Interface::configure(string name, string value) -> bool {
+  ppufast.renderWait();
   return SuperFamicom::configuration.write(name, value);
 }
 
@@ -58,8 +58,20 @@ struct Interface : Emulator::Interface {
   auto rtc() -> bool override;
   auto synchronize(uint64 timestamp) -> void override;
 
+  auto frameRenderTime() -> uint64_t override;
+  auto memoryMapTime() -> uint64_t override;
+  auto tileCacheReads() -> uint64_t override;
+  auto tileCacheDecodes() -> uint64_t override;
+  auto setProfiling(bool enable) -> void override;
+  auto profileJSON() -> string override;
+  auto profileTrace() -> string override;
+
+  auto serializeSize(bool synchronize = true) -> uint override;
   auto serialize(bool synchronize = true) -> serializer override;
   auto unserialize(serializer&) -> bool override;
+  auto serialize(serializer&, bool synchronize, bool incremental) -> bool override;
+  auto unserialize(serializer&, bool incremental) -> bool override;
+  auto trackDirtyPages(bool enable) -> void override;
 
   auto read(uint24 address) -> uint8 override;
   auto cheats(const vector<string>&) -> void override;
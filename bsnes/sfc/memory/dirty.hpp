@@ -0,0 +1,80 @@
+//page-granular write tracking for incremental serialization.
+//while enabled, writes mark the page they touch as dirty. incremental serialization then
+//only transfers dirty pages: saving patches them into the previous snapshot buffer,
+//and loading restores them from it. both clear the dirty bits afterward.
+//the first snapshot written to a buffer must be a full one, and only one buffer
+//may be kept in sync this way at a time.
+//writes made through Memory::data() pointers are not tracked.
+
+struct DirtyPages {
+  enum : uint { PageBits = 8, PageSize = 1 << PageBits };
+  static bool Enable;
+  static bool Incremental;  //set for the duration of an incremental save or load
+
+  DirtyPages() = default;
+  DirtyPages(uint size) { allocate(size); }
+
+  auto allocate(uint size) -> void {
+    pages = (size + PageSize - 1) >> PageBits;
+    bits.reset();
+    bits.resize((pages + 63) >> 6);
+    markAll();
+  }
+
+  alwaysinline auto mark(uint address) -> void {
+    if(!Enable) return;
+    uint page = address >> PageBits;
+    bits[page >> 6] |= 1ull << (page & 63);
+  }
+
+  auto markAll() -> void {
+    for(auto& word : bits) word = ~0ull;
+  }
+
+  //number of dirty pages
+  auto count() const -> uint {
+    uint count = 0;
+    for(uint page : range(pages)) count += bits[page >> 6] >> (page & 63) & 1;
+    return count;
+  }
+
+  //whether serialize() transfers the byte at the address: every byte, unless only dirty pages are transferred
+  auto transfers(serializer& s, uint address) const -> bool {
+    if(!incremental(s)) return true;
+    uint page = address >> PageBits;
+    return bits[page >> 6] >> (page & 63) & 1;
+  }
+
+  template<typename T> auto serialize(serializer& s, T* data, uint count) -> void {
+    if(incremental(s)) {
+      uint size = count * sizeof(T);
+      auto memory = (uint8_t*)data;
+      auto buffer = s.span(size);
+      for(uint page = 0; page < pages && page << PageBits < size; page++) {
+        auto word = bits[page >> 6];
+        if(!word) { page |= 63; continue; }
+        if(!(word >> (page & 63) & 1)) continue;
+        uint offset = page << PageBits;
+        uint length = min((uint)PageSize, size - offset);
+        if(s.mode() == serializer::Save) memory::copy(buffer + offset, memory + offset, length);
+        if(s.mode() == serializer::Load) memory::copy(memory + offset, buffer + offset, length);
+      }
+      for(auto& word : bits) word = 0;
+      return;
+    }
+    s.array(data, count);
+    if(s.mode() == serializer::Load) markAll();
+  }
+
+private:
+  auto incremental(serializer& s) const -> bool {
+    #if defined(ENDIAN_LSB)
+    return Incremental && Enable && s.mode() != serializer::Size;
+    #else
+    return false;
+    #endif
+  }
+
+  vector<uint64_t> bits;
+  uint pages = 0;
+};
@@ -24,9 +24,20 @@ auto Bus::reduce(uint addr, uint mask) -> uint {
 }
 
 auto Bus::read(uint addr, uint8 data) -> uint8 {
-  return reader[lookup[addr]](target[addr], data);
+  auto& page = pages[addr >> PageBits];
+  uint offset = addr & PageMask;
+  if(page.read) return page.read[offset];
+  if(auto detail = page.detail) return reader[detail->id[offset]](detail->target[offset], data);
+  return reader[page.id](page.target + offset, data);
 }
 
 auto Bus::write(uint addr, uint8 data) -> void {
-  return writer[lookup[addr]](target[addr], data);
+  auto& page = pages[addr >> PageBits];
+  uint offset = addr & PageMask;
+  if(page.write) {
+    page.write[offset] = data;
+    return page.dirty->mark(page.target + offset);
+  }
+  if(auto detail = page.detail) return writer[detail->id[offset]](detail->target[offset], data);
+  return writer[page.id](page.target + offset, data);
 }
@@ -3,11 +3,14 @@
 namespace SuperFamicom {
 
 bool Memory::GlobalWriteEnable = false;
+bool DirtyPages::Enable = false;
+bool DirtyPages::Incremental = false;
 Bus bus;
 
 Bus::~Bus() {
-  if(lookup) delete[] lookup;
-  if(target) delete[] target;
+  if(!pages) return;
+  for(uint index : range(Pages)) delete pages[index].detail;
+  delete[] pages;
 }
 
 auto Bus::reset() -> void {
@@ -15,13 +18,17 @@ auto Bus::reset() -> void {
     reader[id].reset();
     writer[id].reset();
     counter[id] = 0;
+    host[id] = {};
   }
+  mapTime = 0;
 
-  if(lookup) delete[] lookup;
-  if(target) delete[] target;
-
-  lookup = new uint8 [16 * 1024 * 1024]();
-  target = new uint32[16 * 1024 * 1024]();
+  if(!pages) pages = new Page[Pages];
+  for(uint index : range(Pages)) {
+    delete pages[index].detail;
+    pages[index] = {};
+  }
+  touched.reset();
+  generation++;
 
   reader[0] = [](uint, uint8 data) -> uint8 { return data; };
   writer[0] = [](uint, uint8) -> void {};
@@ -37,8 +44,20 @@ auto Bus::map(
     if(++id >= 256) return print("SFC error: bus map exhausted\n"), 0;
   }
 
+  auto timeStart = chrono::nanosecond();
   reader[id] = read;
   writer[id] = write;
+  host[id] = {};
+  if(size) base = mirror(base, size);
+
+  //the targets within a page are consecutive when neither the mask nor the mirroring affect the low address bits:
+  //such pages are then mapped at once, from the target of their first address.
+  bool linear = !(mask & PageMask) && (!size || !(size & PageMask) && !(base & PageMask));
+  auto target = [&](uint address) -> uint {
+    uint offset = reduce(address, mask);
+    if(size) offset = base + mirror(offset, size - base);
+    return offset;
+  };
 
   auto p = addr.split(":", 1L);
   auto banks = p(0).split(",");
@@ -53,28 +72,33 @@ auto Bus::map(
       uint addrHi = addrRange(1, addrRange(0)).hex();
 
       for(uint bank = bankLo; bank <= bankHi; bank++) {
-        for(uint addr = addrLo; addr <= addrHi; addr++) {
-          uint pid = lookup[bank << 16 | addr];
-          if(pid && --counter[pid] == 0) {
-            reader[pid].reset();
-            writer[pid].reset();
+        for(uint addr = addrLo; addr <= addrHi;) {
+          auto& page = pages[(bank << 16 | addr) >> PageBits];
+          if(linear && !(addr & PageMask) && addr + PageMask <= addrHi) {
+            assign(page, id, target(bank << 16 | addr));
+            addr += PageSize;
+            continue;
           }
 
-          uint offset = reduce(bank << 16 | addr, mask);
-          if(size) base = mirror(base, size);
-          if(size) offset = base + mirror(offset, size - base);
-          lookup[bank << 16 | addr] = id;
-          target[bank << 16 | addr] = offset;
+          auto& detail = expand(page);
+          uint index = addr & PageMask;
           counter[id]++;
+          release(detail.id[index]);
+          detail.id[index] = id;
+          detail.target[index] = target(bank << 16 | addr);
+          addr++;
         }
       }
     }
   }
 
+  update();
+  mapTime += chrono::nanosecond() - timeStart;
   return id;
 }
 
 auto Bus::unmap(const string& addr) -> void {
+  auto timeStart = chrono::nanosecond();
   auto p = addr.split(":", 1L);
   auto banks = p(0).split(",");
   auto addrs = p(1).split(",");
@@ -88,18 +112,131 @@ auto Bus::unmap(const string& addr) -> void {
       uint addrHi = addrRange(1, addrRange(1)).hex();
 
       for(uint bank = bankLo; bank <= bankHi; bank++) {
-        for(uint addr = addrLo; addr <= addrHi; addr++) {
-          uint pid = lookup[bank << 16 | addr];
-          if(pid && --counter[pid] == 0) {
-            reader[pid].reset();
-            writer[pid].reset();
+        for(uint addr = addrLo; addr <= addrHi;) {
+          auto& page = pages[(bank << 16 | addr) >> PageBits];
+          if(!(addr & PageMask) && addr + PageMask <= addrHi) {
+            assign(page, 0, 0);
+            addr += PageSize;
+            continue;
           }
 
-          lookup[bank << 16 | addr] = 0;
-          target[bank << 16 | addr] = 0;
+          auto& detail = expand(page);
+          uint index = addr & PageMask;
+          release(detail.id[index]);
+          detail.id[index] = 0;
+          detail.target[index] = 0;
+          addr++;
+        }
+      }
+    }
+  }
+
+  update();
+  mapTime += chrono::nanosecond() - timeStart;
+}
+
+//lets the pages mapped to the handler id access data directly, where their targets lie within it
+auto Bus::direct(uint id, uint8* data, uint size, DirtyPages* dirty) -> void {
+  if(!id || !counter[id]) return;
+  host[id] = {data, size, dirty};
+  for(uint index : range(Pages)) {
+    if(pages[index].id == id) refresh(pages[index]);
+  }
+  generation++;
+}
+
+auto Bus::resolve(uint address) const -> Direct {
+  auto& page = pages[address >> PageBits];
+  uint offset = address & PageMask;
+  uint id = page.detail ? page.detail->id[offset] : page.id;
+  uint target = page.detail ? page.detail->target[offset] : page.target + offset;
+  auto& memory = host[id];
+  if(!id || !memory.data || target >= memory.size) return {};
+  return {memory.data + target, memory.dirty, target};
+}
+
+//switches a page to a handler and target per address, so that they can be changed individually
+auto Bus::expand(Page& page) -> Page::Detail& {
+  touch(page);
+  if(!page.detail) {
+    page.detail = new Page::Detail;
+    for(uint index : range(PageSize)) {
+      page.detail->id[index] = page.id;
+      page.detail->target[index] = page.target + index;
+    }
+  }
+  return *page.detail;
+}
+
+//maps every address of a page to the handler id, at consecutive targets
+auto Bus::assign(Page& page, uint id, uint target) -> void {
+  touch(page);
+  if(id) counter[id] += PageSize;
+  if(auto detail = page.detail) {
+    for(uint index : range(PageSize)) release(detail->id[index]);
+    page.detail = nullptr;
+    delete detail;
+  } else {
+    release(page.id, PageSize);
+  }
+  page.id = id;
+  page.target = target;
+}
+
+//drops addresses from the handler id, which is freed along with its last address
+auto Bus::release(uint id, uint count) -> void {
+  if(id && (counter[id] -= count) == 0) {
+    reader[id].reset();
+    writer[id].reset();
+    host[id] = {};
+  }
+}
+
+//queues a page that is about to change for update()
+auto Bus::touch(Page& page) -> void {
+  if(page.touched) return;
+  page.touched = true;
+  touched.append(&page);
+}
+
+//collapses the changed pages that became uniform, and recomputes their direct pointers
+auto Bus::update() -> void {
+  for(auto page : touched) {
+    page->touched = false;
+    if(auto detail = page->detail) {
+      uint id = detail->id[0], target = detail->target[0];
+      bool uniform = true;
+      for(uint offset : range(PageSize)) {
+        if(detail->id[offset] != id || id && detail->target[offset] != target + offset) {
+          uniform = false;
+          break;
         }
       }
+      if(uniform) {
+        page->id = id;
+        page->target = id ? target : 0;
+        page->detail = nullptr;
+        delete detail;
+      }
     }
+    refresh(*page);
+  }
+  touched.reset();
+  generation++;
+}
+
+//points the page at the host memory of its handler, if it has any
+auto Bus::refresh(Page& page) -> void {
+  page.read = nullptr;
+  page.write = nullptr;
+  page.dirty = nullptr;
+  if(page.detail || !page.id) return;
+  auto& memory = host[page.id];
+  if(!memory.data || page.target + PageSize > memory.size) return;
+  page.read = memory.data + page.target;
+  if(memory.dirty) {
+    page.write = memory.data + page.target;
+    page.dirty = memory.dirty;
   }
 }
 
@@ -16,11 +16,19 @@ struct Memory {
   uint id = 0;
 };
 
+#include "dirty.hpp"
 #include "readable.hpp"
 #include "writable.hpp"
 #include "protectable.hpp"
 
+//the 24-bit address space is split into 256-byte pages.
+//a page whose addresses all go to the same handler, at consecutive targets, is stored as that handler and its first target;
+//any other page keeps a handler and target per address.
+//pages of memory registered with direct() are accessed through host pointers, without calling the handlers.
+
 struct Bus {
+  enum : uint { PageBits = 8, PageSize = 1 << PageBits, PageMask = PageSize - 1, Pages = 1 << 24 - PageBits };
+
   alwaysinline static auto mirror(uint address, uint size) -> uint;
   alwaysinline static auto reduce(uint address, uint mask) -> uint;
 
@@ -36,14 +44,56 @@ struct Bus {
     const string& address, uint size = 0, uint base = 0, uint mask = 0
   ) -> uint;
   auto unmap(const string& address) -> void;
+  auto direct(uint id, uint8* data, uint size, DirtyPages* dirty = nullptr) -> void;
+
+  //the host memory an address is accessed through, where its handler permits it
+  struct Direct {
+    uint8* data = nullptr;  //for reads; for writes too when dirty is set
+    DirtyPages* dirty = nullptr;
+    uint target = 0;
+  };
+  auto resolve(uint address) const -> Direct;
+
+  uint64_t mapTime = 0;  //nanoseconds spent mapping since the last reset
+  uint generation = 0;   //changes whenever the map does
 
 private:
-  uint8* lookup = nullptr;
-  uint32* target = nullptr;
+  struct Page {
+    struct Detail {
+      uint8 id[PageSize];
+      uint32 target[PageSize];
+    };
+
+    uint8* read = nullptr;   //host memory of the page, when reads may bypass the handler
+    uint8* write = nullptr;  //host memory of the page, when writes may bypass the handler
+    DirtyPages* dirty = nullptr;
+    uint32 target = 0;
+    uint8 id = 0;
+    bool touched = false;
+    Detail* detail = nullptr;
+  };
+
+  auto expand(Page& page) -> Page::Detail&;
+  auto assign(Page& page, uint id, uint target) -> void;
+  auto release(uint id, uint count = 1) -> void;
+  auto touch(Page& page) -> void;
+  auto update() -> void;
+  auto refresh(Page& page) -> void;
+
+  Page* pages = nullptr;
+  vector<Page*> touched;
 
   function<uint8 (uint, uint8)> reader[256];
   function<void  (uint, uint8)> writer[256];
   uint counter[256];
+
+  //memory with no side effects on access, which the handler reads from and writes to directly;
+  //dirty is set when the handler also permits writes, which then only need to be tracked.
+  struct Host {
+    uint8* data = nullptr;
+    uint size = 0;
+    DirtyPages* dirty = nullptr;
+  } host[256];
 };
 
 extern Bus bus;
@@ -13,6 +13,7 @@ struct ProtectableMemory : Memory {
     for(uint address : range(size)) {
       self.data[address] = fill;
     }
+    dirty.allocate(size);
   }
 
   inline auto data() -> uint8* override {
@@ -38,6 +39,7 @@ struct ProtectableMemory : Memory {
   inline auto write(uint address, uint8 data) -> void override {
     if(self.writable || Memory::GlobalWriteEnable) {
       self.data[address] = data;
+      dirty.mark(address);
     }
   }
 
@@ -45,6 +47,8 @@ struct ProtectableMemory : Memory {
     return self.data[address];
   }
 
+  DirtyPages dirty;
+
 private:
   struct {
     uint8* data = nullptr;
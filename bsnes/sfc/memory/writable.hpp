@@ -13,6 +13,7 @@ struct WritableMemory : Memory {
     for(uint address : range(size)) {
       self.data[address] = fill;
     }
+    dirty.allocate(size);
   }
 
   inline auto data() -> uint8* override {
@@ -29,12 +30,17 @@ struct WritableMemory : Memory {
 
   inline auto write(uint address, uint8 data) -> void override {
     self.data[address] = data;
+    dirty.mark(address);
   }
 
+  //the returned reference may be written to, so the page is conservatively marked dirty
   inline auto operator[](uint address) -> uint8& {
+    dirty.mark(address);
     return self.data[address];
   }
 
+  DirtyPages dirty;
+
 private:
   struct {
     uint8* data = nullptr;
@@ -117,30 +117,13 @@ auto PPU::Line::renderBackground(PPU::IO::Background& self, uint8 source) -> voi
     uint16 address;
     address = ppu.vramExt((tileNumber << colorShift) + (voffset & 7 ^ mirrorY)) /*& 0x7fff*/;
 
-    uint64 data;
-    data  = (uint64)ppu.vram[address +  0] <<  0;
-    data |= (uint64)ppu.vram[address +  8] << 16;
-    data |= (uint64)ppu.vram[address + 16] << 32;
-    data |= (uint64)ppu.vram[address + 24] << 48;
+    uint64_t data = ppu.tileCache.row(self.tileMode, address);
+    tileReads++;
 
     for(uint tileX = 0; tileX < 8; tileX++, x++) {
       if(x < -ws || x >= width + ws) continue;   //if(x & width) continue;  //x < 0 || x >= width
       if(--mosaicCounter == 0) {
-        uint color, shift = mirrorX ? tileX : 7 - tileX;
-      /*if(self.tileMode >= TileMode::BPP2)*/ {
-          color  = data >> shift +  0 &   1;
-          color += data >> shift +  7 &   2;
-        }
-        if(self.tileMode >= TileMode::BPP4) {
-          color += data >> shift + 14 &   4;
-          color += data >> shift + 21 &   8;
-        }
-        if(self.tileMode >= TileMode::BPP8) {
-          color += data >> shift + 28 &  16;
-          color += data >> shift + 35 &  32;
-          color += data >> shift + 42 &  64;
-          color += data >> shift + 49 & 128;
-        }
+        uint color = data >> (mirrorX ? 7 - tileX : tileX) * 8 & 0xff;
 
         mosaicCounter = self.mosaicEnable ? io.mosaic.size : 1;
         mosaicPalette = color;
@@ -196,5 +179,5 @@ auto PPU::Line::getTile(PPU::IO::Background& self, uint hoffset, uint voffset) -
   uint offset = (tileY & 0x1f) << 5 | (tileX & 0x1f);
   if(tileX & 0x20) offset += screenX;
   if(tileY & 0x20) offset += screenY;
-  return ppu.vram[ppu.vramExt(self.screenAddress + offset) /*& 0x7fff*/];
+  return ppu.renderState.vram[ppu.vramExt(self.screenAddress + offset) /*& 0x7fff*/];
 }
@@ -0,0 +1,151 @@
+//compositing of a row of pixels: color window clipping, and add/subtract/halve color math against the sub screen or the fixed color.
+//the colors have already been through the light table. every kernel must give the same results as Line::pixel(), bit for bit.
+
+auto PPU::Line::compositeSpan(const Pixels& above, const Pixels& below, uint x, uint count, uint32 fixedColor, uint32* output) const -> CompositeSpan {
+  CompositeSpan span{};
+  span.count = count;
+  span.aboveSource = above.source + x;
+  span.aboveColor = above.color + x;
+  span.belowSource = below.source + x;
+  span.belowColor = below.color + x;
+  span.clip = windowAbove + (ppufast.winIgnored(false) ? ppufast.winXadHd(x, false) : x);
+  span.clipStride = !ppufast.winIgnored(false);
+  span.math = windowBelow + (ppufast.winIgnored(true) ? ppufast.winXadHd(x, true) : x);
+  span.mathStride = !ppufast.winIgnored(true);
+  span.halve = windowAbove + x;
+  for(uint source : range(7)) span.enable[source] = io.col.enable[source];
+  span.blendMode = io.col.blendMode;
+  span.halveEnable = io.col.halve;
+  span.subtract = io.col.mathMode;
+  span.fixedColor = fixedColor;
+  span.output = output;
+  return span;
+}
+
+static auto compositeRange(const PPU::Line::CompositeSpan& span, uint begin) -> void {
+  for(uint n = begin; n < span.count; n++) {
+    uint32 above = span.clip[n * span.clipStride] ? span.aboveColor[n] : 0;
+    if(!span.math[n * span.mathStride] || !span.enable[span.aboveSource[n]]) {
+      span.output[n] = above;
+    } else if(!span.blendMode) {
+      span.output[n] = PPU::Line::blend(above, span.fixedColor, span.halveEnable && span.halve[n], span.subtract);
+    } else {
+      bool halve = span.halveEnable && span.halve[n] && span.belowSource[n] != PPU::Source::COL;
+      span.output[n] = PPU::Line::blend(above, span.belowColor[n], halve, span.subtract);
+    }
+  }
+}
+
+static auto compositeScalar(const PPU::Line::CompositeSpan& span) -> void {
+  compositeRange(span, 0);
+}
+
+#if defined(PPU_FAST_SIMD)
+//four pixels at a time. the windows are bool arrays, so a pixel's entry widens to an all-ones or all-zeroes lane
+__attribute__((target("sse4.1")))
+static auto compositeSSE41(const PPU::Line::CompositeSpan& span) -> void {
+  #define bytes(data) _mm_cvtsi32_si128(memory::readl<4>((const uint8*)(data)))
+  #define lanes(bytes) _mm_cmpgt_epi32(_mm_cvtepu8_epi32(bytes), _mm_setzero_si128())
+  const auto enable = _mm_loadu_si128((const __m128i*)span.enable);
+  const auto clipAll = _mm_set1_epi32(span.clip[0] ? -1 : 0);
+  const auto mathAll = _mm_set1_epi32(span.math[0] ? -1 : 0);
+  const auto halveEnable = _mm_set1_epi32(span.halveEnable ? -1 : 0);
+  const auto fixedColor = _mm_set1_epi32(span.fixedColor);
+  const auto col = _mm_set1_epi32(PPU::Source::COL);
+
+  uint n = 0;
+  for(; n + 4 <= span.count; n += 4) {
+    auto clip = span.clipStride ? lanes(bytes(span.clip + n)) : clipAll;
+    auto math = span.mathStride ? lanes(bytes(span.math + n)) : mathAll;
+    math = _mm_and_si128(math, lanes(_mm_shuffle_epi8(enable, bytes(span.aboveSource + n))));
+    auto halve = _mm_and_si128(halveEnable, lanes(bytes(span.halve + n)));
+
+    auto x = _mm_and_si128(_mm_loadu_si128((const __m128i*)(span.aboveColor + n)), clip);
+    auto y = fixedColor;
+    if(span.blendMode) {
+      y = _mm_loadu_si128((const __m128i*)(span.belowColor + n));
+      halve = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_cvtepu8_epi32(bytes(span.belowSource + n)), col), halve);
+    }
+
+    __m128i full, half;
+    if(!span.subtract) {
+      auto sum = _mm_add_epi32(x, y);
+      auto odd = _mm_and_si128(_mm_xor_si128(x, y), _mm_set1_epi32(0x00010101));
+      auto carry = _mm_and_si128(_mm_sub_epi32(sum, odd), _mm_set1_epi32(0x01010100));
+      full = _mm_or_si128(_mm_sub_epi32(sum, carry), _mm_sub_epi32(carry, _mm_srli_epi32(carry, 8)));
+      half = _mm_srli_epi32(_mm_sub_epi32(sum, odd), 1);
+    } else {
+      auto diff = _mm_add_epi32(_mm_sub_epi32(x, y), _mm_set1_epi32(0x01010100));
+      auto borrow = _mm_and_si128(_mm_sub_epi32(diff, _mm_and_si128(_mm_xor_si128(x, y), _mm_set1_epi32(0x01010100))), _mm_set1_epi32(0x01010100));
+      full = _mm_and_si128(_mm_sub_epi32(diff, borrow), _mm_sub_epi32(borrow, _mm_srli_epi32(borrow, 8)));
+      half = _mm_srli_epi32(_mm_and_si128(full, _mm_set1_epi32(0x00fefefe)), 1);
+    }
+    auto blended = _mm_blendv_epi8(full, half, halve);
+    _mm_storeu_si128((__m128i*)(span.output + n), _mm_blendv_epi8(x, blended, math));
+  }
+  #undef bytes
+  #undef lanes
+  compositeRange(span, n);
+}
+
+//eight pixels at a time
+__attribute__((target("avx2")))
+static auto compositeAVX2(const PPU::Line::CompositeSpan& span) -> void {
+  #define bytes(data) _mm_loadl_epi64((const __m128i*)(data))
+  #define lanes(bytes) _mm256_cmpgt_epi32(_mm256_cvtepu8_epi32(bytes), _mm256_setzero_si256())
+  const auto enable = _mm_loadu_si128((const __m128i*)span.enable);
+  const auto clipAll = _mm256_set1_epi32(span.clip[0] ? -1 : 0);
+  const auto mathAll = _mm256_set1_epi32(span.math[0] ? -1 : 0);
+  const auto halveEnable = _mm256_set1_epi32(span.halveEnable ? -1 : 0);
+  const auto fixedColor = _mm256_set1_epi32(span.fixedColor);
+  const auto col = _mm256_set1_epi32(PPU::Source::COL);
+
+  uint n = 0;
+  for(; n + 8 <= span.count; n += 8) {
+    auto clip = span.clipStride ? lanes(bytes(span.clip + n)) : clipAll;
+    auto math = span.mathStride ? lanes(bytes(span.math + n)) : mathAll;
+    math = _mm256_and_si256(math, lanes(_mm_shuffle_epi8(enable, bytes(span.aboveSource + n))));
+    auto halve = _mm256_and_si256(halveEnable, lanes(bytes(span.halve + n)));
+
+    auto x = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(span.aboveColor + n)), clip);
+    auto y = fixedColor;
+    if(span.blendMode) {
+      y = _mm256_loadu_si256((const __m256i*)(span.belowColor + n));
+      halve = _mm256_andnot_si256(_mm256_cmpeq_epi32(_mm256_cvtepu8_epi32(bytes(span.belowSource + n)), col), halve);
+    }
+
+    __m256i full, half;
+    if(!span.subtract) {
+      auto sum = _mm256_add_epi32(x, y);
+      auto odd = _mm256_and_si256(_mm256_xor_si256(x, y), _mm256_set1_epi32(0x00010101));
+      auto carry = _mm256_and_si256(_mm256_sub_epi32(sum, odd), _mm256_set1_epi32(0x01010100));
+      full = _mm256_or_si256(_mm256_sub_epi32(sum, carry), _mm256_sub_epi32(carry, _mm256_srli_epi32(carry, 8)));
+      half = _mm256_srli_epi32(_mm256_sub_epi32(sum, odd), 1);
+    } else {
+      auto diff = _mm256_add_epi32(_mm256_sub_epi32(x, y), _mm256_set1_epi32(0x01010100));
+      auto borrow = _mm256_and_si256(_mm256_sub_epi32(diff, _mm256_and_si256(_mm256_xor_si256(x, y), _mm256_set1_epi32(0x01010100))), _mm256_set1_epi32(0x01010100));
+      full = _mm256_and_si256(_mm256_sub_epi32(diff, borrow), _mm256_sub_epi32(borrow, _mm256_srli_epi32(borrow, 8)));
+      half = _mm256_srli_epi32(_mm256_and_si256(full, _mm256_set1_epi32(0x00fefefe)), 1);
+    }
+    auto blended = _mm256_blendv_epi8(full, half, halve);
+    _mm256_storeu_si256((__m256i*)(span.output + n), _mm256_blendv_epi8(x, blended, math));
+  }
+  #undef bytes
+  #undef lanes
+  compositeRange(span, n);
+}
+#endif
+
+auto PPU::Line::composite(const CompositeSpan& span) -> void {
+  #if defined(PPU_FAST_SIMD)
+  static const auto kernel = [] {
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return compositeAVX2;
+    if(__builtin_cpu_supports("sse4.1")) return compositeSSE41;
+    return compositeScalar;
+  }();
+  return kernel(span);
+  #else
+  return compositeScalar(span);
+  #endif
+}
@@ -0,0 +1,140 @@
+//HD fixed color gradients and window smoothing blend each line's state with that of its neighbors.
+//the state they compare lines by is gathered once per batch of rendered lines, and each line then sums its
+//neighbors' values through prefix sums, rather than comparing whole lines once per sub-line and distance.
+
+auto PPU::Line::cacheLineStates() -> void {
+  for(uint y : range(240)) {
+    auto& io = ppu.lines[y].io;
+    auto& state = ppu.lineStates[y];
+    state.colorMath = (uint64_t)io.col.halve << 0 | io.col.mathMode << 1 | io.col.blendMode << 2;
+    for(uint n : range(7)) state.colorMath |= (uint64_t)io.col.enable[n] << 3 + n;
+    state.colorMath |= (uint64_t)io.bg1.tileMode << 16 | (uint64_t)io.bg2.tileMode << 24;
+    state.colorMath |= (uint64_t)io.bg3.tileMode << 32 | (uint64_t)io.bg4.tileMode << 40;
+
+    state.window = (uint64_t)io.col.halve << 0 | io.col.mathMode << 1 | io.col.blendMode << 2;
+    state.window |= (uint64_t)(io.window.oneLeft >= io.window.oneRight) << 3;
+    state.window |= (uint64_t)(io.window.twoLeft >= io.window.twoRight) << 4;
+    state.window |= (uint64_t)io.col.window.oneEnable << 5 | io.col.window.oneInvert << 6;
+    state.window |= (uint64_t)io.col.window.twoEnable << 7 | io.col.window.twoInvert << 8;
+    state.window |= (uint64_t)(uint8)io.col.window.mask << 16 | (uint64_t)(uint8)io.col.window.aboveMask << 24;
+    state.window |= (uint64_t)(uint8)io.col.window.belowMask << 32;
+
+    state.fixedColor = io.col.fixedColor;
+    state.edges[0] = io.window.oneLeft;
+    state.edges[1] = io.window.oneRight;
+    state.edges[2] = io.window.twoLeft;
+    state.edges[3] = io.window.twoRight;
+  }
+}
+
+//sums the values of the rows within dist lines of each of this line's HD rows, stopping at the first row above
+//or below that lies outside of the screen (at or above line top; or below line 223) or on a line that fails.
+//rows are mapped to lines by (truncating) division, so the rows just above the screen belong to its first line.
+template<uint Channels, typename Fails, typename Value>
+auto PPU::Line::gradient(uint dist, int top, const Fails& fails, const Value& value, int sums[][Channels], int counts[]) const -> void {
+  int scale = ppufast.hd() ? ppufast.hdScale() : 1;
+  int y = this->y;
+  int reach = dist * scale;
+
+  int values[224][Channels];
+  if(y <= top || y >= 224 || !dist) {
+    value(y, values[0]);
+    for(uint offset : range(scale)) {
+      for(uint c : range(Channels)) sums[offset][c] = values[0][c];
+      counts[offset] = 1;
+    }
+    return;
+  }
+
+  //the nearest lines the sums stop at, and prefix sums of the values of the lines in between
+  int above = y - (int)dist - 1;
+  int below = y + (int)dist + 1;
+  for(int line = y - 1; line >= y - (int)dist; line--) {
+    if(line <= top || fails(line)) { above = line; break; }
+  }
+  for(int line = y + 1; line <= y + (int)dist; line++) {
+    if(line >= 224 || fails(line)) { below = line; break; }
+  }
+  int first = max(above + 1, 0);
+  int prefix[225][Channels];
+  for(uint c : range(Channels)) prefix[first][c] = 0;
+  for(int line = first; line < below; line++) {
+    value(line, values[line]);
+    for(uint c : range(Channels)) prefix[line + 1][c] = prefix[line][c] + values[line][c];
+  }
+  //the sum of the values of the rows from the first line up to (not including) row
+  auto rows = [&](int row, uint c) -> int {
+    if(row < 0) return row * values[0][c];
+    int line = row / scale, sub = row % scale;
+    return prefix[line][c] * scale + (sub ? sub * values[line][c] : 0);
+  };
+
+  int aboveRow = above >= 0 ? above * scale + scale - 1 : -scale;
+  for(int offset = 0; offset < scale; offset++) {
+    int row = y * scale + offset;
+    int distance = min(min(row - aboveRow, below * scale - row), reach + 1) - 1;
+    for(uint c : range(Channels)) {
+      sums[offset][c] = values[y][c] + rows(row, c) - rows(row - distance, c) + rows(row + distance + 1, c) - rows(row + 1, c);
+    }
+    counts[offset] = 1 + 2 * distance;
+  }
+}
+
+//the fixed color of each HD row, averaged with the rows within dist lines of it
+//for as long as they share this line's color math and their colors are close enough
+auto PPU::Line::fixedColorGradient(uint dist, uint32 colors[]) const -> void {
+  auto luma = ppu.lightTable[io.displayBrightness];
+  auto& state = ppu.lineStates[y];
+  uint32 t = luma[io.col.fixedColor];
+  int aBase = (t >> 16) & 255;
+  int bBase = (t >>  8) & 255;
+  int cBase = (t >>  0) & 255;
+
+  auto fails = [&](int line) -> bool {
+    auto& neighbor = ppu.lineStates[line];
+    if(neighbor.colorMath != state.colorMath) return true;
+    uint32 t = luma[neighbor.fixedColor];
+    int a = (t >> 16) & 255;
+    int b = (t >>  8) & 255;
+    int c = (t >>  0) & 255;
+    return abs(a - aBase) + abs(b - bBase) + abs(c - cBase) > 76;
+  };
+  auto value = [&](int line, int channels[3]) -> void {
+    uint32 t = line == y ? luma[io.col.fixedColor] : luma[ppu.lineStates[line].fixedColor];
+    channels[0] = (t >> 16) & 255;
+    channels[1] = (t >>  8) & 255;
+    channels[2] = (t >>  0) & 255;
+  };
+
+  int sums[10][3], counts[10];
+  gradient<3>(dist, -1, fails, value, sums, counts);
+  int scale = ppufast.hd() ? ppufast.hdScale() : 1;
+  for(uint offset : range(scale)) {
+    uint32 a = (uint32)sums[offset][0] / counts[offset];
+    uint32 b = (uint32)sums[offset][1] / counts[offset];
+    uint32 c = (uint32)sums[offset][2] / counts[offset];
+    colors[offset] = (a << 16) + (b << 8) + (c << 0);
+  }
+}
+
+//the summed window edges of each HD row and the rows within dist lines of it, for as long as
+//they share this line's color window configuration and their edges are within a few pixels
+auto PPU::Line::windowEdgeGradient(uint dist, int edges[][4], int counts[]) const -> void {
+  const int THRESHOLD = 4;
+  auto& state = ppu.lineStates[y];
+  int base[4] = {io.window.oneLeft, io.window.oneRight, io.window.twoLeft, io.window.twoRight};
+
+  auto fails = [&](int line) -> bool {
+    auto& neighbor = ppu.lineStates[line];
+    if(neighbor.window != state.window) return true;
+    for(uint n : range(4)) {
+      if(abs(neighbor.edges[n] - base[n]) > THRESHOLD) return true;
+    }
+    return false;
+  };
+  auto value = [&](int line, int channels[4]) -> void {
+    for(uint n : range(4)) channels[n] = line == y ? base[n] : ppu.lineStates[line].edges[n];
+  };
+
+  gradient<4>(dist, 0, fails, value, edges, counts);
+}
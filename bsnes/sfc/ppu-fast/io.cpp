@@ -38,6 +38,8 @@ auto PPU::writeVRAM(uint8 data) -> void {
   if constexpr(Byte == 1) {
     vram[address] = vram[address] & 0x00ff | data << 8;
   }
+  vramDirty.mark(address << 1);
+  tileCache.invalidate(address);
 }
 
 auto PPU::readOAM(uint10 address) -> uint8 {
@@ -72,6 +74,7 @@ auto PPU::writeCGRAM(uint8 address, uint15 data) -> void {
   && cpu.hcounter() >= 88 && cpu.hcounter() < 1096
   ) address = latch.cgramAddress;
   cgram[address] = data;
+  cgramDirty.mark(address << 1);
 }
 
 auto PPU::readIO(uint address, uint8 data) -> uint8 {
@@ -3,100 +3,201 @@ uint PPU::Line::start = 0;
 uint PPU::Line::count = 0;
 
 auto PPU::Line::flush() -> void {
+  //while pipelined, flushes with nothing to render (eg VRAM writes during vblank) must not stall on the render in progress
+  if(ppu.pipelined && !Line::count) return;
+  renderLines(false);
+}
+
+//called by the CPU once the visible portion of a frame has been emulated
+auto PPU::Line::flushFrame() -> void {
+  if(!ppu.pipelined || system.frameCounter || system.runAhead) return flush();
+  //the lines below the visible area are blank: include them now, rather than stalling on them at scanline 240
+  if(!Line::count) Line::start = ppu.vdisp();
+  for(uint y = ppu.vdisp(); y < 240; y++) ppu.pipeline->lines[y].io.displayDisable = true;
+  Line::count = 240 - Line::start;
+  renderLines(true);
+}
 
+auto PPU::Line::latchRenderState() -> void {
   ppu.wsExt = HdToolkit::determineWsExt(ppu.widescreenRaw(),
         configuration.video.overscan, configuration.video.aspectCorrection);
+  if(!ppu.videoTargetRequested && !system.frameCounter && !system.runAhead) ppu.requestVideoTarget();
+
+  auto& state = ppu.renderState;
+  state.interlace = ppubase.display.interlace;
+  state.overscan = ppu.latch.overscan;
+  state.hires = ppu.latch.hires;
+  state.hd = ppu.latch.hd;
+  state.ss = ppu.latch.ss;
+  state.field = ppu.field();
+  state.aboveMask = ppu.io.col.window.aboveMask;
+  state.belowMask = ppu.io.col.window.belowMask;
+  state.vram = ppu.vram;
+  state.objects = ppu.objects;
+  state.output = ppu.output;
+  //the lines are only rendered to the frontend's memory in the geometry it was requested for
+  bool matches = state.hd && (256 + 2 * ppu.wsExt) * ppu.hdScale() == ppu.videoTargetWidth;
+  state.target = matches ? ppu.videoTarget : Emulator::Platform::VideoTarget{};
+}
 
-  if (ppu.luminance != configuration.video.luminance ||
-        ppu.saturation != configuration.video.saturation ||
-        ppu.gamma != configuration.video.gamma) {
-    uint luminance = configuration.video.luminance;
-    uint saturation = configuration.video.saturation;
-    uint gamma = configuration.video.gamma;
-    ppu.luminance = luminance;
-    ppu.saturation = saturation;
-    ppu.gamma = gamma;
-    for(uint l : range(16)) {
-      if (ppu.lightTable[l]) delete [] ppu.lightTable[l];
-      ppu.lightTable[l] = new uint32_t[32768];
-      for(uint r : range(32)) {
-        for(uint g : range(32)) {
-          for(uint b : range(32)) {
-            double dr = r * 255.0 / 31.0;
-            double dg = g * 255.0 / 31.0;
-            double db = b * 255.0 / 31.0;
-  
-            if(saturation != 100) {
-              double satVal = saturation / 100.0;
-              double grayInv = (dr + dg + db) / 3 * max(0.0, 1.0 - satVal);
-              dr = dr * satVal + grayInv;
-              dg = dg * satVal + grayInv;
-              db = db * satVal + grayInv;
-            }
-  
-            if(gamma != 100) {
-              double gamVal = gamma / 100.0;
-              double reciprocal = 1.0 / 127.0;
-              dr = dr > 127.0 ? dr : 127.0 * pow(dr * reciprocal, gamVal);
-              dg = dg > 127.0 ? dg : 127.0 * pow(dg * reciprocal, gamVal);
-              db = db > 127.0 ? db : 127.0 * pow(db * reciprocal, gamVal);
-            }
+//sprite overflow found by the renderer becomes visible to the CPU at the next flush
+auto PPU::Line::applyOverflow() -> void {
+  if(ppu.overflow.range) ppu.io.obj.rangeOver = true;
+  if(ppu.overflow.time) ppu.io.obj.timeOver = true;
+  ppu.overflow = {};
+}
 
-            if(luminance != 100) {
-              double lumVal = luminance / 100.0;
-              dr *= lumVal;
-              dg *= lumVal;
-              db *= lumVal;
-            }
+//returns true when the table had to be regenerated
+auto PPU::Line::updateLightTable() -> bool {
+  uint luminance = configuration.video.luminance;
+  uint saturation = configuration.video.saturation;
+  uint gamma = configuration.video.gamma;
+  if(ppu.lightTable.matches(luminance, saturation, gamma)) return false;
+  ppu.workers.resize(ppu.renderThreads());
+  ppu.lightTable.generate(luminance, saturation, gamma, ppu.workers);
+  return true;
+}
 
-            double lVal = l / 15.0;
-            dr *= lVal;
-            dg *= lVal;
-            db *= lVal;
-
-            int ar = dr + 0.5;
-            int ag = dg + 0.5;
-            int ab = db + 0.5;
-            if (ar > 255) ar = 255;
-            if (ag > 255) ag = 255;
-            if (ab > 255) ab = 255;
-            if (ar < 0) ar = 0;
-            if (ag < 0) ag = 0;
-            if (ab < 0) ab = 0;
-
-            ppu.lightTable[l][r << 10 | g << 5 | b << 0] = ab << 16 | ag << 8 | ar << 0;
-          }
-        }
+//async: the lines are rendered by the workers while emulation continues (see PPU::Pipeline)
+auto PPU::Line::renderLines(bool async) -> void {
+  auto timeStart = chrono::nanosecond();
+  ppu.renderWait();
+  latchRenderState();
+  bool changed = updateLightTable();
+
+  if(Line::count) {
+    uint start = Line::start;
+    uint count = Line::count;
+    ppu.tileCache.update(ppu.vram);
+    if(ppu.pipelined) {
+      for(uint y : range(count)) {
+        auto& staged = ppu.pipeline->lines[start + y];
+        memcpy(&ppu.lines[start + y].io, &staged.io, sizeof(io));
+        memcpy(&ppu.lines[start + y].cgram, &staged.cgram, sizeof(cgram));
       }
     }
+    if(ppu.hdScale() > 1) cacheMode7HD();
+    if(ppu.hdScale() > 0) cacheMode7Endpoints();
+    if(ppu.bgGrad() || ppu.windRad()) cacheLineStates();
+    cacheObjects();
+    ppu.renderState.wsOverride = ppu.mode7LineGroups.count < 1;
+
+    //lines rendered ahead of time are only kept if the frame state they were rendered with still holds
+    auto& incremental = ppu.incremental;
+    if(incremental.count && (changed || incremental.state != ppu.renderState || incremental.wsExt != ppu.wsExt
+    || incremental.reach != max(ppu.bgGrad(), ppu.windRad()))) {
+      incremental.reset();
+      ppu.overflow = {};
+    }
+    uint queued = 0;
+    for(uint y = start; y < start + count; y++) {
+      if(!incremental.rendered[y]) ppu.renderQueue[queued++] = y;
+    }
+    incremental.reset();
+    applyOverflow();
+
+    ppu.workers.resize(ppu.renderThreads());
+    //small batches of lines are not worth waking up the workers for
+    uint batch = queued < 8 ? queued : 2;
+    if(async) {
+      auto& pipeline = *ppu.pipeline;
+      memcpy(pipeline.vram, ppu.vram, sizeof(ppu.vram));
+      memcpy(pipeline.objects, ppu.objects, sizeof(ppu.objects));
+      ppu.renderState.vram = pipeline.vram;
+      ppu.renderState.objects = pipeline.objects;
+      pipeline.rendering = {true, ppu.renderState, ppu.output, ppu.wsExt, ppu.hdScale()};
+      ppu.workers.start(queued, batch, renderQueued);
+      //emulation of the next frame continues into the other buffer
+      swap(ppu.output, pipeline.output);
+    } else {
+      ppu.workers.run(queued, batch, renderQueued);
+      applyOverflow();
+    }
+    Line::start = 0;
+    Line::count = 0;
+  } else {
+    applyOverflow();
   }
+  ppu.renderTime += chrono::nanosecond() - timeStart;
+}
 
-  if(Line::count) {
-    if(ppu.hdScale() > 1) cacheMode7HD();
-    #pragma omp parallel for if(Line::count >= 8)
-    for(uint y = 0; y < Line::count; y++) {
-      if(ppu.deinterlace()) {
-        if(!ppu.interlace()) {
-          //some games enable interlacing in 240p mode, just force these to even fields
-          ppu.lines[Line::start + y].render(0);
-        } else {
-          //for actual interlaced frames, render both fields every farme for 480i -> 480p
-          ppu.lines[Line::start + y].render(0);
-          ppu.lines[Line::start + y].render(1);
-        }
+//incremental rendering: hands the lines cached so far to the workers in chunks while emulation continues.
+//the final flush of the frame validates them (see renderLines), so the output is identical to flushing at once.
+auto PPU::Line::renderAhead() -> void {
+  auto& incremental = ppu.incremental;
+  uint begin = max(incremental.next, Line::start);
+  uint end = Line::start + Line::count;
+  //HD gradients and window smoothing blend each line with the lines below it (see gradient), so the last
+  //lines cached so far are held back until those have been cached too
+  if(end < begin + Incremental::Chunk + max(ppu.bgGrad(), ppu.windRad())) return;
+
+  auto timeStart = chrono::nanosecond();
+  ppu.renderWait();
+  latchRenderState();
+  bool changed = updateLightTable();
+  ppu.tileCache.update(ppu.vram);
+  if(ppu.bgGrad() || ppu.windRad()) cacheLineStates();
+  cacheObjects();
+  uint reach = max(ppu.bgGrad(), ppu.windRad());
+  if(incremental.count && (changed || incremental.state != ppu.renderState || incremental.wsExt != ppu.wsExt
+  || incremental.reach != reach)) {
+    //the frame state changed: the lines rendered so far will be rendered again by the flush
+    incremental.reset();
+    ppu.overflow = {};
+  }
+  incremental.state = ppu.renderState;
+  incremental.wsExt = ppu.wsExt;
+  incremental.reach = reach;
+  uint last = end > begin + reach ? end - reach : begin;
+
+  uint queued = 0;
+  for(uint y = begin; y < last; y++) {
+    //mode 7 lines are interpolated across their group (see cacheMode7HD), so they are left to the flush
+    auto& line = ppu.lines[y];
+    if(line.io.bg1.tileMode == TileMode::Mode7 && !line.io.displayDisable) continue;
+    incremental.rendered[y] = true;
+    ppu.renderQueue[queued++] = y;
+  }
+  incremental.count += queued;
+  incremental.next = last;
+
+  ppu.workers.resize(ppu.renderThreads());
+  ppu.workers.start(queued, 2, renderQueued);
+  ppu.renderTime += chrono::nanosecond() - timeStart;
+}
+
+auto PPU::Line::renderQueued(uint begin, uint end) -> void {
+  for(uint n = begin; n < end; n++) {
+    auto& line = ppu.lines[ppu.renderQueue[n]];
+    if(ppu.deinterlace()) {
+      if(!ppu.interlace()) {
+        //some games enable interlacing in 240p mode, just force these to even fields
+        line.render(0);
       } else {
-        //standard 240p (progressive) and 480i (interlaced) rendering
-        ppu.lines[Line::start + y].render(ppu.field());
+        //for actual interlaced frames, render both fields every farme for 480i -> 480p
+        line.render(0);
+        line.render(1);
       }
+    } else {
+      //standard 240p (progressive) and 480i (interlaced) rendering
+      line.render(ppu.renderState.field);
     }
-    Line::start = 0;
-    Line::count = 0;
   }
 }
 
 auto PPU::Line::cache() -> void {
   uint y = ppu.vcounter();
-  if(ppu.io.displayDisable || y >= ppu.vdisp()) {
+  if(ppu.pipelined) {
+    //the lines may still be in use by the render of the previous frame, so the state is staged instead
+    if(y >= ppu.vdisp()) return;  //see flushFrame()
+    auto& staged = ppu.pipeline->lines[y];
+    if(ppu.io.displayDisable) {
+      staged.io.displayDisable = true;
+    } else {
+      memcpy(&staged.io, &ppu.io, sizeof(io));
+      memcpy(&staged.cgram, &ppu.cgram, sizeof(cgram));
+    }
+  } else if(ppu.io.displayDisable || y >= ppu.vdisp()) {
     io.displayDisable = true;
   } else {
     memcpy(&io, &ppu.io, sizeof(io));
@@ -104,76 +205,88 @@ auto PPU::Line::cache() -> void {
   }
   if(!Line::count) Line::start = y;
   Line::count++;
+  if(ppu.renderIncremental()) renderAhead();
 }
 
-auto PPU::Line::avgBgC(uint dist, uint offset) const -> uint32 {
-  auto luma = ppu.lightTable[io.displayBrightness];
-  uint32 t = luma[io.col.fixedColor];
-  if(dist < 1) return t;
-  int32 aBase = (t >> 16) & 255;
-  int32 bBase = (t >>  8) & 255;
-  int32 cBase = (t >>  0) & 255;
-  uint32 a = aBase;
-  uint32 b = bBase;
-  uint32 c = cBase;
-  int32 aU = 0;
-  int32 bU = 0;
-  int32 cU = 0;
-  int32 aD = 0;
-  int32 bD = 0;
-  int32 cD = 0;
-  int scale = ppufast.hd() ? ppufast.hdScale() : 1;
-  int hdY = y * scale + offset;
-  int count = 1;
-  for (int i = 1; i <= dist*scale; i++) {
-    int uY = (hdY-i)/scale;
-    int dY = (hdY+i)/scale;
-    if(uY < 0 || dY >= 224) break; /////////////////////////////
-    auto uL = ppufast.lines[uY];
-    auto dL = ppufast.lines[dY];
-    if( io.col.halve     != dL.io.col.halve     || io.col.halve     != uL.io.col.halve     ||
-        io.col.mathMode  != dL.io.col.mathMode  || io.col.mathMode  != uL.io.col.mathMode  ||
-        io.col.blendMode != dL.io.col.blendMode || io.col.blendMode != uL.io.col.blendMode ||
-        io.col.enable[0] != dL.io.col.enable[0] || io.col.enable[0] != uL.io.col.enable[0] ||
-        io.col.enable[1] != dL.io.col.enable[1] || io.col.enable[1] != uL.io.col.enable[1] ||
-        io.col.enable[2] != dL.io.col.enable[2] || io.col.enable[2] != uL.io.col.enable[2] ||
-        io.col.enable[3] != dL.io.col.enable[3] || io.col.enable[3] != uL.io.col.enable[3] ||
-        io.col.enable[4] != dL.io.col.enable[4] || io.col.enable[4] != uL.io.col.enable[4] ||
-        io.col.enable[5] != dL.io.col.enable[5] || io.col.enable[5] != uL.io.col.enable[5] ||
-        io.col.enable[6] != dL.io.col.enable[6] || io.col.enable[6] != uL.io.col.enable[6] ||
-        io.bg1.tileMode  != dL.io.bg1.tileMode  || io.bg1.tileMode  != uL.io.bg1.tileMode  ||
-        io.bg2.tileMode  != dL.io.bg2.tileMode  || io.bg2.tileMode  != uL.io.bg2.tileMode  ||
-        io.bg3.tileMode  != dL.io.bg3.tileMode  || io.bg3.tileMode  != uL.io.bg3.tileMode  ||
-        io.bg4.tileMode  != dL.io.bg4.tileMode  || io.bg4.tileMode  != uL.io.bg4.tileMode) break; 
-    t = luma[uL.io.col.fixedColor];
-    aU = (t >> 16) & 255;
-    bU = (t >>  8) & 255;
-    cU = (t >>  0) & 255;
-    t = luma[dL.io.col.fixedColor];
-    aD = (t >> 16) & 255;
-    bD = (t >>  8) & 255;
-    cD = (t >>  0) & 255;
-    if (((abs(aU - aBase) + abs(bU - bBase) + abs(cU - cBase)) > 76) ||
-        ((abs(aD - aBase) + abs(bD - bBase) + abs(cD - cBase)) > 76)) break;
-    a += aU + aD;
-    b += bU + bD;
-    c += cU + cD;
-    count += 2;
+#if defined(BUILD_DEBUG)
+std::atomic<uint> PPU::Scratch::allocations{0};
+#endif
+
+PPU::Scratch::~Scratch() {
+  resize(0);
+  delete[] positions;
+  delete[] pixelX;
+  delete[] pixelY;
+  delete[] palette;
+  delete[] accumulators;
+}
+
+auto PPU::Scratch::resize(uint size) -> void {
+  if(this->size == size) return;
+  for(auto pixels : {&above, &below}) {
+    delete[] pixels->source;
+    delete[] pixels->priority;
+    delete[] pixels->color;
+    *pixels = {};
+  }
+  delete[] windowAbove;
+  delete[] windowBelow;
+  windowAbove = windowBelow = nullptr;
+  if(this->size = size) {
+    for(auto pixels : {&above, &below}) {
+      pixels->source = new uint8[size];
+      pixels->priority = new uint8[size];
+      pixels->color = new uint32[size];
+    }
+    windowAbove = new bool[size];
+    windowBelow = new bool[size];
+    #if defined(BUILD_DEBUG)
+    allocations++;
+    #endif
+  }
+}
+
+auto PPU::Scratch::resizeMode7(uint samples, uint accumulators) -> void {
+  if(samples > this->samples) {
+    delete[] positions;
+    delete[] pixelX;
+    delete[] pixelY;
+    delete[] palette;
+    positions = new float[samples];
+    pixelX = new int[samples];
+    pixelY = new int[samples];
+    palette = new uint8[samples];
+    this->samples = samples;
+    #if defined(BUILD_DEBUG)
+    allocations++;
+    #endif
+  }
+  if(accumulators > accumulatorSize) {
+    delete[] this->accumulators;
+    this->accumulators = new uint[accumulators];
+    accumulatorSize = accumulators;
+    #if defined(BUILD_DEBUG)
+    allocations++;
+    #endif
   }
-  a /= count;
-  b /= count;
-  c /= count;
-  return (a << 16) + (b << 8) + (c << 0);
 }
 
 auto PPU::Line::render(bool fieldID) -> void {
   this->fieldID = fieldID;
-  uint y = this->y + (!ppu.latch.overscan ? 7 : 0);
+  uint y = this->y + (!ppu.overscan() ? 7 : 0);
 
   auto hd = ppu.hd();
   auto ss = ppu.ss();
   auto scale = ppufast.hd() ? ppufast.hdScale() : 1;
-  auto output = ppu.output + (!hd
+
+  static thread_local Scratch scratch;
+  scratch.resize((256+2*ppu.widescreen()) * scale * scale);
+  this->scratch = &scratch;
+  above = scratch.above;
+  below = scratch.below;
+  windowAbove = scratch.windowAbove;
+  windowBelow = scratch.windowBelow;
+  auto output = ppu.renderState.output + (!hd
   ? (y * 1024 + (ppu.interlace() && field() ? 512 : 0))
   : (y * (256+2*ppu.widescreen()) * scale * scale)
   );
@@ -181,8 +294,17 @@ auto PPU::Line::render(bool fieldID) -> void {
   ? (!ppu.hires() ? 256 : 512)
   : ((256+2*ppu.widescreen()) * scale * scale));
 
+  //HD lines are output as scale rows each, which go to the frontend's memory when it displays them
+  auto row = [&, base = output, y](uint ySub) -> uint32* {
+    auto& target = ppu.renderState.target;
+    uint n = y * scale + ySub;
+    if(target && n >= target.top && n < target.top + target.height) return target.data + (n - target.top) * target.pitch;
+    return base + ySub * (256+2*ppu.widescreen()) * scale;
+  };
+
   if(io.displayDisable) {
-    memory::fill<uint32>(output, width);
+    if(!hd) memory::fill<uint32>(output, width);
+    else for(uint ySub : range(scale)) memory::fill<uint32>(row(ySub), (256+2*ppu.widescreen()) * scale);
     return;
   }
 
@@ -190,30 +312,37 @@ auto PPU::Line::render(bool fieldID) -> void {
   
   auto luma = ppu.lightTable[io.displayBrightness];
   auto aboveColor = luma[cgram[0]];
-  uint32 *bgFixedColors = new uint32[10];
-  uint32 *belowColors = new uint32[10];
+  uint32 bgFixedColors[10];
+  uint32 belowColors[10];
+  fixedColorGradient(ppufast.bgGrad(), bgFixedColors);
   for (int i = 0; i < scale; i++) {
-    bgFixedColors[i] = avgBgC(ppufast.bgGrad(), i);
     belowColors[i]  = hires ? aboveColor : bgFixedColors[i];
   }
 
   uint xa =  (hd || ss) && ppu.interlace() && field() ? (256+2*ppu.widescreen())  * scale * scale / 2 : 0;
-  uint xb = !(hd || ss) ? 256 : ppu.interlace() && !ppu.field() ? (256+2*ppu.widescreen()) * scale * scale / 2 : (256+2*ppu.widescreen()) * scale * scale;
+  uint xb = !(hd || ss) ? 256 : ppu.interlace() && !ppu.renderState.field ? (256+2*ppu.widescreen()) * scale * scale / 2 : (256+2*ppu.widescreen()) * scale * scale;
   if (hd && ppu.wsBgCol() && ppu.widescreen() > 0) {
     for(uint x = xa; x < xb; x++) {
       int cx = (x % ((256+2*ppu.widescreen()) * scale)) - (ppu.widescreen() * scale);
       if (cx >= 0 && cx < (256 * scale)) {
-        above[x] = {Source::COL, 0, aboveColor};
-        below[x] = {Source::COL, 0, belowColors[x / ((256+2*ppufast.widescreen()) * scale)]};
+        above.assign(x, {Source::COL, 0, aboveColor});
+        below.assign(x, {Source::COL, 0, belowColors[x / ((256+2*ppufast.widescreen()) * scale)]});
       } else {
-        above[x] = {Source::COL, 0, 0};
-        below[x] = {Source::COL, 0, 0};
+        above.assign(x, {Source::COL, 0, 0});
+        below.assign(x, {Source::COL, 0, 0});
       }
     }
   } else {
-    for(uint x = xa; x < xb; x++) {
-      above[x] = {Source::COL, 0, aboveColor};
-      below[x] = {Source::COL, 0, belowColors[x / ((256+2*ppufast.widescreen()) * scale)]};
+    memory::fill<uint8>(above.source + xa, xb - xa, Source::COL);
+    memory::fill<uint8>(above.priority + xa, xb - xa, 0);
+    memory::fill<uint32>(above.color + xa, xb - xa, aboveColor);
+    memory::fill<uint8>(below.source + xa, xb - xa, Source::COL);
+    memory::fill<uint8>(below.priority + xa, xb - xa, 0);
+    uint rowWidth = (256+2*ppufast.widescreen()) * scale;
+    for(uint x = xa; x < xb;) {
+      uint end = min(xb, (x / rowWidth + 1) * rowWidth);
+      memory::fill<uint32>(below.color + x, end - x, belowColors[x / rowWidth]);
+      x = end;
     }
   }
 
@@ -229,70 +358,15 @@ auto PPU::Line::render(bool fieldID) -> void {
   if(io.extbg == 1) renderBackground(io.bg2, Source::BG2);
 
   //TODO: move to own method
-  int THRESHOLD = 4;
   y = this->y;
-  uint windRad = ppufast.windRad();
+  int windowEdges[10][4], windowCounts[10];
+  windowEdgeGradient(ppufast.windRad(), windowEdges, windowCounts);
   for (int offset = 0; offset < scale; offset++) {
-    int oneLeft  = io.window.oneLeft;
-    int oneRight = io.window.oneRight;
-    int twoLeft  = io.window.twoLeft;
-    int twoRight = io.window.twoRight;
-
-    int hdY = y * scale + offset;
-    int count = 1;
-    for (int i = 1; i <= windRad*scale; i++) {
-      int uY = (hdY-i)/scale;
-      int dY = (hdY+i)/scale;
-      if(uY <= 0 || dY >= 224) break;
-      auto uL = ppufast.lines[uY];
-      auto dL = ppufast.lines[dY];
-
-      if( io.col.halve     != dL.io.col.halve     || io.col.halve     != uL.io.col.halve     ||
-          io.col.mathMode  != dL.io.col.mathMode  || io.col.mathMode  != uL.io.col.mathMode  ||
-          io.col.blendMode != dL.io.col.blendMode || io.col.blendMode != uL.io.col.blendMode ||
-          (io.window.oneLeft >= io.window.oneRight) != (dL.io.window.oneLeft >= dL.io.window.oneRight) ||
-          (io.window.oneLeft >= io.window.oneRight) != (uL.io.window.oneLeft >= uL.io.window.oneRight) ||
-          (io.window.twoLeft >= io.window.twoRight) != (dL.io.window.twoLeft >= dL.io.window.twoRight) ||
-          (io.window.twoLeft >= io.window.twoRight) != (uL.io.window.twoLeft >= uL.io.window.twoRight) ||
-          io.col.window.oneEnable != dL.io.col.window.oneEnable ||
-          io.col.window.oneEnable != uL.io.col.window.oneEnable ||
-          io.col.window.oneInvert != dL.io.col.window.oneInvert ||
-          io.col.window.oneInvert != uL.io.col.window.oneInvert ||
-          io.col.window.twoEnable != dL.io.col.window.twoEnable ||
-          io.col.window.twoEnable != uL.io.col.window.twoEnable ||
-          io.col.window.twoInvert != dL.io.col.window.twoInvert ||
-          io.col.window.twoInvert != uL.io.col.window.twoInvert ||
-          io.col.window.mask != dL.io.col.window.mask ||
-          io.col.window.mask != uL.io.col.window.mask ||
-          io.col.window.aboveMask != dL.io.col.window.aboveMask ||
-          io.col.window.aboveMask != uL.io.col.window.aboveMask ||
-          io.col.window.belowMask != dL.io.col.window.belowMask ||
-          io.col.window.belowMask != uL.io.col.window.belowMask
-          || dL.io.window.oneLeft - io.window.oneLeft > THRESHOLD
-          || io.window.oneLeft - dL.io.window.oneLeft > THRESHOLD
-          || uL.io.window.oneLeft - io.window.oneLeft > THRESHOLD
-          || io.window.oneLeft - uL.io.window.oneLeft > THRESHOLD
-          || dL.io.window.oneRight - io.window.oneRight > THRESHOLD
-          || io.window.oneRight - dL.io.window.oneRight > THRESHOLD
-          || uL.io.window.oneRight - io.window.oneRight > THRESHOLD
-          || io.window.oneRight - uL.io.window.oneRight > THRESHOLD
-          || dL.io.window.twoLeft - io.window.twoLeft > THRESHOLD
-          || io.window.twoLeft - dL.io.window.twoLeft > THRESHOLD
-          || uL.io.window.twoLeft - io.window.twoLeft > THRESHOLD
-          || io.window.twoLeft - uL.io.window.twoLeft > THRESHOLD
-          || dL.io.window.twoRight - io.window.twoRight > THRESHOLD
-          || io.window.twoRight - dL.io.window.twoRight > THRESHOLD
-          || uL.io.window.twoRight - io.window.twoRight > THRESHOLD
-          || io.window.twoRight - uL.io.window.twoRight > THRESHOLD
-          ) break; 
-
-      oneLeft  += dL.io.window.oneLeft  + uL.io.window.oneLeft;
-      oneRight += dL.io.window.oneRight + uL.io.window.oneRight;
-      twoLeft  += dL.io.window.twoLeft  + uL.io.window.twoLeft;
-      twoRight += dL.io.window.twoRight + uL.io.window.twoRight;
-
-      count += 2;
-    }
+    int oneLeft  = windowEdges[offset][0];
+    int oneRight = windowEdges[offset][1];
+    int twoLeft  = windowEdges[offset][2];
+    int twoRight = windowEdges[offset][3];
+    int count = windowCounts[offset];
     if (ppu.strwin()) {
       oneLeft  *= 2;
       oneRight *= 2;
@@ -379,123 +453,144 @@ auto PPU::Line::render(bool fieldID) -> void {
           temporalReady = temporalAbove && temporalBelow;
         }
       }
-      int xIndex = 0;
-      for(uint ySub : range(scale)) {
-        for(uint i : range(widthScaled)) {
-          int destX = xIndex++;
-          int column = destX % (int)widthScaled;
-          int row = destX / (int)widthScaled;
-          int sampleColumn = column;
-          bool outside = column < leftEdge || column >= rightEdge;
-          bool originalEmpty = outside && above[destX].priority == 0 && below[destX].priority == 0;
-          bool applyMask = false;
-          bool allowTemporalWrite = true;
-          int fade = 0;
-
-          auto computeFade = [&](int col) {
-            if(col < leftEdge) {
-              return leftMaxDist > 0 ? fadeMax * (leftMaxDist - col) / leftMaxDist : fadeMax;
-            }
-            int dist = col - rightEdge;
-            return rightMaxDist > 0 ? fadeMax * dist / rightMaxDist : fadeMax;
-          };
-
-          if(originalEmpty) {
-            if(handling == 1) { // clamp
-              sampleColumn = column < leftEdge ? leftEdge : rightEdge - 1;
-            } else if(handling == 2) { // mirror
-              if(column < leftEdge) {
-                int offset = leftEdge - 1 - column;
-                sampleColumn = leftEdge + offset;
-              } else {
-                int offset = column - rightEdge;
-                sampleColumn = rightEdge - 1 - offset;
-              }
-              if(sampleColumn < leftEdge) sampleColumn = leftEdge;
-              if(sampleColumn >= rightEdge) sampleColumn = rightEdge - 1;
-            } else if(handling == 3) { // mask
-              applyMask = true;
-              fade = computeFade(column);
-            }
+      //the columns of the picture itself are composited at once: only those of the extension need handling
+      auto extension = [&](uint ySub, int column) {
+        int row = ySub;
+        int destX = row * (int)widthScaled + column;
+        int sampleColumn = column;
+        bool outside = column < leftEdge || column >= rightEdge;
+        bool originalEmpty = outside && above[destX].priority == 0 && below[destX].priority == 0;
+        bool applyMask = false;
+        bool allowTemporalWrite = true;
+        int fade = 0;
+
+        auto computeFade = [&](int col) {
+          if(col < leftEdge) {
+            return leftMaxDist > 0 ? fadeMax * (leftMaxDist - col) / leftMaxDist : fadeMax;
           }
-
-          int sampleIndex = row * (int)widthScaled + sampleColumn;
-          Pixel srcAbove = above[sampleIndex];
-          Pixel srcBelow = below[sampleIndex];
-
-          if(useTemporal && originalEmpty) {
-            Pixel prevAbove = {};
-            Pixel prevBelow = {};
-            if(temporalReady) {
-              uint index = (temporalBaseRow + row) * temporalWidth + column;
-              prevAbove = temporalAbove[index];
-              prevBelow = temporalBelow[index];
-            }
-            if(prevAbove.priority || prevBelow.priority) {
-              srcAbove = prevAbove;
-              srcBelow = prevBelow;
-              applyMask = false;
+          int dist = col - rightEdge;
+          return rightMaxDist > 0 ? fadeMax * dist / rightMaxDist : fadeMax;
+        };
+
+        if(originalEmpty) {
+          if(handling == 1) { // clamp
+            sampleColumn = column < leftEdge ? leftEdge : rightEdge - 1;
+          } else if(handling == 2) { // mirror
+            if(column < leftEdge) {
+              int offset = leftEdge - 1 - column;
+              sampleColumn = leftEdge + offset;
             } else {
-              applyMask = true;
-              allowTemporalWrite = false;
-              fade = computeFade(column);
+              int offset = column - rightEdge;
+              sampleColumn = rightEdge - 1 - offset;
             }
+            if(sampleColumn < leftEdge) sampleColumn = leftEdge;
+            if(sampleColumn >= rightEdge) sampleColumn = rightEdge - 1;
+          } else if(handling == 3) { // mask
+            applyMask = true;
+            fade = computeFade(column);
           }
+        }
 
-          if(applyMask) {
-            auto applyFade = [&](Pixel& p) {
-              uint32 color = p.color;
-              uint r = color >> 16 & 255;
-              uint g = color >>  8 & 255;
-              uint b = color >>  0 & 255;
-              r = r * (255 - fade) / 255;
-              g = g * (255 - fade) / 255;
-              b = b * (255 - fade) / 255;
-              p.color = (r << 16) | (g << 8) | (b << 0);
-            };
-            applyFade(srcAbove);
-            applyFade(srcBelow);
+        int sampleIndex = row * (int)widthScaled + sampleColumn;
+        Pixel srcAbove = above[sampleIndex];
+        Pixel srcBelow = below[sampleIndex];
+
+        if(useTemporal && originalEmpty) {
+          Pixel prevAbove = {};
+          Pixel prevBelow = {};
+          if(temporalReady) {
+            uint index = (temporalBaseRow + row) * temporalWidth + column;
+            prevAbove = temporalAbove[index];
+            prevBelow = temporalBelow[index];
+          }
+          if(prevAbove.priority || prevBelow.priority) {
+            srcAbove = prevAbove;
+            srcBelow = prevBelow;
+            applyMask = false;
+          } else {
+            applyMask = true;
+            allowTemporalWrite = false;
+            fade = computeFade(column);
           }
+        }
+
+        if(applyMask) {
+          auto applyFade = [&](Pixel& p) {
+            uint32 color = p.color;
+            uint r = color >> 16 & 255;
+            uint g = color >>  8 & 255;
+            uint b = color >>  0 & 255;
+            r = r * (255 - fade) / 255;
+            g = g * (255 - fade) / 255;
+            b = b * (255 - fade) / 255;
+            p.color = (r << 16) | (g << 8) | (b << 0);
+          };
+          applyFade(srcAbove);
+          applyFade(srcBelow);
+        }
 
-          *output++ = pixel(destX, srcAbove, srcBelow, ppu.widescreen(), wsm, wsma, bgFixedColors[ySub]);
+        output[column] = pixel(destX, srcAbove, srcBelow, ppu.widescreen(), wsm, wsma, bgFixedColors[ySub]);
 
-          if(useTemporal && temporalReady && allowTemporalWrite) {
-            uint index = (temporalBaseRow + row) * temporalWidth + column;
-            temporalAbove[index] = srcAbove;
-            temporalBelow[index] = srcBelow;
+        if(useTemporal && temporalReady && allowTemporalWrite) {
+          uint index = (temporalBaseRow + row) * temporalWidth + column;
+          temporalAbove[index] = srcAbove;
+          temporalBelow[index] = srcBelow;
+        }
+      };
+      for(uint ySub : range(scale)) {
+        output = row(ySub);
+        uint start = ySub * widthScaled;
+        composite(compositeSpan(above, below, start + leftEdge, rightEdge - leftEdge, bgFixedColors[ySub], output + leftEdge));
+        if(useTemporal && temporalReady) {
+          uint index = (temporalBaseRow + ySub) * temporalWidth;
+          for(int column = leftEdge; column < rightEdge; column++) {
+            temporalAbove[index + column] = above[start + column];
+            temporalBelow[index + column] = below[start + column];
           }
         }
+        for(int column = 0; column < leftEdge; column++) extension(ySub, column);
+        for(int column = rightEdge; column < (int)widthScaled; column++) extension(ySub, column);
+      }
+    } else if(!wsm) {
+      //without widescreen markers, each row is composited at once
+      for(uint ySub : range(scale)) {
+        composite(compositeSpan(above, below, ySub * widthScaled, widthScaled, bgFixedColors[ySub], row(ySub)));
       }
     } else {
       int x = 0;
       for(uint ySub : range(scale)) {
+        output = row(ySub);
         for(uint i : range(widthScaled)) {
           *output++ = pixel(x, above[x], below[x], ppu.widescreen(), wsm, wsma, bgFixedColors[ySub]);
           x++;
         }
       }
     }
-  } else if(width == 256) for(uint x : range(256)) {
-    *output++ = pixel(x, above[x], below[x], 0, 0, 0, bgFixedColors[0]);
-  } else if(!hires) for(uint x : range(256)) {
-    auto color = pixel(x, above[x], below[x], 0, 0, 0, bgFixedColors[0]);
-    *output++ = color;
-    *output++ = color;
-  } else if(!configuration.video.blurEmulation) for(uint x : range(256)) {
-    *output++ = pixel(x, below[x], above[x], 0, 0, 0, bgFixedColors[0]);
-    *output++ = pixel(x, above[x], below[x], 0, 0, 0, bgFixedColors[0]);
-  } else for(uint x : range(256)) {
-    curr = pixel(x, below[x], above[x], 0, 0, 0, bgFixedColors[0]);
-    *output++ = (prev + curr - ((prev ^ curr) & 0x00010101)) >> 1;
-    prev = curr;
-    curr = pixel(x, above[x], below[x], 0, 0, 0, bgFixedColors[0]);
-    *output++ = (prev + curr - ((prev ^ curr) & 0x00010101)) >> 1;
-    prev = curr;
+  } else if(width == 256) {
+    composite(compositeSpan(above, below, 0, 256, bgFixedColors[0], output));
+  } else {
+    //the main screen, and (when hires) the sub screen in between its pixels
+    uint32 main[256], sub[256];
+    composite(compositeSpan(above, below, 0, 256, bgFixedColors[0], main));
+    if(!hires) for(uint x : range(256)) {
+      *output++ = main[x];
+      *output++ = main[x];
+    } else {
+      composite(compositeSpan(below, above, 0, 256, bgFixedColors[0], sub));
+      if(!configuration.video.blurEmulation) for(uint x : range(256)) {
+        *output++ = sub[x];
+        *output++ = main[x];
+      } else for(uint x : range(256)) {
+        curr = sub[x];
+        *output++ = (prev + curr - ((prev ^ curr) & 0x00010101)) >> 1;
+        prev = curr;
+        curr = main[x];
+        *output++ = (prev + curr - ((prev ^ curr) & 0x00010101)) >> 1;
+        prev = curr;
+      }
+    }
   }
 
-  delete [] bgFixedColors;
-  delete [] belowColors;
-
 }
 
 auto PPU::Line::pixel(uint x, Pixel above, Pixel below, uint ws, uint wsm,
@@ -504,8 +599,8 @@ auto PPU::Line::pixel(uint x, Pixel above, Pixel below, uint ws, uint wsm,
   if(!windowAbove[ppufast.winXadHd(x, false)]) above.color = 0x0000;
   if(!windowBelow[ppufast.winXadHd(x, true)]) r = above.color;
   else if(!io.col.enable[above.source]) r = above.color;
-  else if(!io.col.blendMode) r = blend(above.color, bgFixedColor, io.col.halve && windowAbove[x]);
-  else r = blend(above.color, below.color, io.col.halve && windowAbove[x] && below.source != Source::COL);
+  else if(!io.col.blendMode) r = blend(above.color, bgFixedColor, io.col.halve && windowAbove[x], io.col.mathMode);
+  else r = blend(above.color, below.color, io.col.halve && windowAbove[x] && below.source != Source::COL, io.col.mathMode);
   if(wsm > 0) {
     x /= ppufast.hdScale();
     x %= 256 + 2 * ws;
@@ -519,8 +614,8 @@ auto PPU::Line::pixel(uint x, Pixel above, Pixel below, uint ws, uint wsm,
   return r;
 }
 
-auto PPU::Line::blend(uint x, uint y, bool halve) const -> uint32 {
-  if(!io.col.mathMode) {  //add
+auto PPU::Line::blend(uint x, uint y, bool halve, bool subtract) -> uint32 {
+  if(!subtract) {  //add
     if(!halve) {
       uint sum = x + y;
       uint carry = (sum - ((x ^ y) & 0x00010101)) & 0x01010100;
@@ -550,31 +645,34 @@ auto PPU::Line::directColor(uint paletteIndex, uint paletteColor) const -> uint3
 
 auto PPU::Line::plotAbove(int x, uint8 source, uint8 priority, uint32 color) -> void {
   if(ppu.hd() || ppu.ss()) return plotHD(above, x, source, priority, color, false, false);
-  if(priority > above[x].priority) above[x] = {source, priority, color};
+  if(priority > above.priority[x]) above.assign(x, {source, priority, color});
 }
 
 auto PPU::Line::plotBelow(int x, uint8 source, uint8 priority, uint32 color) -> void {
   if(ppu.hd() || ppu.ss()) return plotHD(below, x, source, priority, color, false, false);
-  if(priority > below[x].priority) below[x] = {source, priority, color};
+  if(priority > below.priority[x]) below.assign(x, {source, priority, color});
 }
 
 //todo: name these variables more clearly ...
-auto PPU::Line::plotHD(Pixel* pixel, int x, uint8 source, uint8 priority, uint32 color, bool hires, bool subpixel) -> void {
+auto PPU::Line::plotHD(Pixels& pixels, int x, uint8 source, uint8 priority, uint32 color, bool hires, bool subpixel) -> void {
   int scale = ppu.hdScale();
   int wss = ppu.widescreen() * scale;
   int xss = hires && subpixel ? (scale / 2 + ((scale & 1 == 1) && (x & 1 == 1))) : 0;
-  int ys = ppu.interlace() && ppu.field() ? scale / 2 : 0;
-  if(priority > pixel[x * scale + xss + ys * 256 * scale + wss].priority) {
-    Pixel p = {source, priority, color};
+  int ys = ppu.interlace() && ppu.renderState.field ? scale / 2 : 0;
+  if(priority > pixels.priority[x * scale + xss + ys * 256 * scale + wss]) {
     int xsm = hires && !subpixel ? (scale / 2 + ((scale & 1 == 1) && (x & 1 == 1))) : scale;
-    int ysm = ppu.interlace() && !ppu.field() ? scale / 2 : scale;
-    for(int xs = xss; xs < xsm; xs++) {
-      pixel[x * scale + xs + ys * 256 * scale + wss] = p;
-    }
-    int size = sizeof(Pixel) * (xsm - xss);
-    Pixel* source = &pixel[x * scale + xss + ys * 256 * scale + wss];
-    for(int yst = ys + 1; yst < ysm; yst++) {
-      memcpy(&pixel[x * scale + xss + yst * (256+2*ppu.widescreen()) * scale + wss], source, size);
+    int ysm = ppu.interlace() && !ppu.renderState.field ? scale / 2 : scale;
+    int width = (256+2*ppu.widescreen()) * scale;
+    //the planes are written through locals: their byte stores could otherwise alias the pointers
+    auto sources = pixels.source, priorities = pixels.priority;
+    auto colors = pixels.color;
+    for(int yst = ys; yst < ysm; yst++) {
+      int offset = x * scale + (yst == ys ? ys * 256 * scale : yst * width) + wss;
+      for(int xs = xss; xs < xsm; xs++) {
+        sources[offset + xs] = source;
+        priorities[offset + xs] = priority;
+        colors[offset + xs] = color;
+      }
     }
   }
 }
@@ -0,0 +1,125 @@
+//sampling of the mode 7 plane for a row of HD sub-pixels.
+//every kernel must give the same results as the scalar one, bit for bit:
+//the products are rounded before they are added (no fused multiply-add), and x / 256 equals x * (1 / 256) exactly.
+
+static auto sampleMode7HDRange(const PPU::Line::Mode7Span& span, uint begin) -> void {
+  for(uint n = begin; n < span.count; n++) {
+    float offsetX = span.a * span.xf[n];
+    float offsetY = span.c * span.xf[n];
+    int pixelX = (span.originX + offsetX) / 256;
+    int pixelY = (span.originY + offsetY) / 256;
+
+    uint tile    = span.repeat == 3 && ((pixelX | pixelY) & ~1023) ? 0 : (span.vram[(pixelY >> 3 & 127) * 128 + (pixelX >> 3 & 127)] & 0xff);
+    uint palette = span.repeat == 2 && ((pixelX | pixelY) & ~1023) ? 0 : (span.vram[(((pixelY & 7) << 3) + (pixelX & 7)) + (tile << 6)] >> 8);
+
+    span.pixelX[n] = pixelX;
+    span.pixelY[n] = pixelY;
+    span.palette[n] = palette;
+  }
+}
+
+static auto sampleMode7HDScalar(const PPU::Line::Mode7Span& span) -> void {
+  sampleMode7HDRange(span, 0);
+}
+
+#if defined(PPU_FAST_SIMD)
+//four sub-pixels at a time; SSE has no gather, so only the coordinates and addresses are vectorized
+__attribute__((target("sse4.1")))
+static auto sampleMode7HDSSE41(const PPU::Line::Mode7Span& span) -> void {
+  const auto a = _mm_set1_ps(span.a);
+  const auto c = _mm_set1_ps(span.c);
+  const auto originX = _mm_set1_ps(span.originX);
+  const auto originY = _mm_set1_ps(span.originY);
+  const auto scale = _mm_set1_ps(1.0f / 256);
+  const auto tileMask = _mm_set1_epi32(span.repeat == 3 ? -1 : 0);
+  const auto paletteMask = _mm_set1_epi32(span.repeat == 2 ? -1 : 0);
+
+  uint n = 0;
+  for(; n + 4 <= span.count; n += 4) {
+    auto xf = _mm_loadu_ps(span.xf + n);
+    auto pixelX = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(originX, _mm_mul_ps(a, xf)), scale));
+    auto pixelY = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(originY, _mm_mul_ps(c, xf)), scale));
+    _mm_storeu_si128((__m128i*)(span.pixelX + n), pixelX);
+    _mm_storeu_si128((__m128i*)(span.pixelY + n), pixelY);
+
+    auto inside = _mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(pixelX, pixelY), _mm_set1_epi32(~1023)), _mm_setzero_si128());
+    auto tileAddress = _mm_or_si128(
+      _mm_and_si128(_mm_slli_epi32(pixelY, 4), _mm_set1_epi32(127 << 7)),
+      _mm_and_si128(_mm_srli_epi32(pixelX, 3), _mm_set1_epi32(127))
+    );
+    auto pixelAddress = _mm_or_si128(
+      _mm_slli_epi32(_mm_and_si128(pixelY, _mm_set1_epi32(7)), 3),
+      _mm_and_si128(pixelX, _mm_set1_epi32(7))
+    );
+    auto tileKeep = _mm_or_si128(inside, _mm_xor_si128(tileMask, _mm_set1_epi32(-1)));
+    auto paletteKeep = _mm_or_si128(inside, _mm_xor_si128(paletteMask, _mm_set1_epi32(-1)));
+
+    #define lane(k) { \
+      uint tile = span.vram[_mm_extract_epi32(tileAddress, k)] & 0xff & _mm_extract_epi32(tileKeep, k); \
+      uint palette = span.vram[_mm_extract_epi32(pixelAddress, k) + (tile << 6)] >> 8 & _mm_extract_epi32(paletteKeep, k); \
+      span.palette[n + k] = palette; \
+    }
+    lane(0) lane(1) lane(2) lane(3)
+    #undef lane
+  }
+  sampleMode7HDRange(span, n);
+}
+
+//eight sub-pixels at a time, with the tile and pixel fetches gathered.
+//the gathers read 32 bits for each 16-bit VRAM word; the addresses stay below 16384, well inside VRAM.
+__attribute__((target("avx2")))
+static auto sampleMode7HDAVX2(const PPU::Line::Mode7Span& span) -> void {
+  const auto a = _mm256_set1_ps(span.a);
+  const auto c = _mm256_set1_ps(span.c);
+  const auto originX = _mm256_set1_ps(span.originX);
+  const auto originY = _mm256_set1_ps(span.originY);
+  const auto scale = _mm256_set1_ps(1.0f / 256);
+  const auto tileMask = _mm256_set1_epi32(span.repeat == 3 ? -1 : 0);
+  const auto paletteMask = _mm256_set1_epi32(span.repeat == 2 ? -1 : 0);
+  const auto vram = (const int*)span.vram;
+
+  uint n = 0;
+  for(; n + 8 <= span.count; n += 8) {
+    auto xf = _mm256_loadu_ps(span.xf + n);
+    auto pixelX = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_add_ps(originX, _mm256_mul_ps(a, xf)), scale));
+    auto pixelY = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_add_ps(originY, _mm256_mul_ps(c, xf)), scale));
+    _mm256_storeu_si256((__m256i*)(span.pixelX + n), pixelX);
+    _mm256_storeu_si256((__m256i*)(span.pixelY + n), pixelY);
+
+    auto outside = _mm256_xor_si256(_mm256_set1_epi32(-1), _mm256_cmpeq_epi32(
+      _mm256_and_si256(_mm256_or_si256(pixelX, pixelY), _mm256_set1_epi32(~1023)), _mm256_setzero_si256()
+    ));
+    auto tileAddress = _mm256_or_si256(
+      _mm256_and_si256(_mm256_slli_epi32(pixelY, 4), _mm256_set1_epi32(127 << 7)),
+      _mm256_and_si256(_mm256_srli_epi32(pixelX, 3), _mm256_set1_epi32(127))
+    );
+    auto tile = _mm256_and_si256(_mm256_i32gather_epi32(vram, tileAddress, 2), _mm256_set1_epi32(0xff));
+    tile = _mm256_andnot_si256(_mm256_and_si256(outside, tileMask), tile);
+
+    auto pixelAddress = _mm256_add_epi32(_mm256_or_si256(
+      _mm256_slli_epi32(_mm256_and_si256(pixelY, _mm256_set1_epi32(7)), 3),
+      _mm256_and_si256(pixelX, _mm256_set1_epi32(7))
+    ), _mm256_slli_epi32(tile, 6));
+    auto palette = _mm256_and_si256(_mm256_srli_epi32(_mm256_i32gather_epi32(vram, pixelAddress, 2), 8), _mm256_set1_epi32(0xff));
+    palette = _mm256_andnot_si256(_mm256_and_si256(outside, paletteMask), palette);
+
+    auto packed = _mm_packus_epi32(_mm256_castsi256_si128(palette), _mm256_extracti128_si256(palette, 1));
+    _mm_storel_epi64((__m128i*)(span.palette + n), _mm_packus_epi16(packed, packed));
+  }
+  sampleMode7HDRange(span, n);
+}
+#endif
+
+auto PPU::Line::sampleMode7HD(const Mode7Span& span) -> void {
+  #if defined(PPU_FAST_SIMD)
+  static const auto kernel = [] {
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) return sampleMode7HDAVX2;
+    if(__builtin_cpu_supports("sse4.1")) return sampleMode7HDSSE41;
+    return sampleMode7HDScalar;
+  }();
+  return kernel(span);
+  #else
+  return sampleMode7HDScalar(span);
+  #endif
+}
@@ -95,56 +95,64 @@ auto PPU::Line::cacheMode7HD() -> void {
   }
 }
 
+//find the first and last scanline for interpolation of each line to be rendered, once for all of its layers
+auto PPU::Line::cacheMode7Endpoints() -> void {
+  #define isLineMode7(n) (ppu.lines[n].io.bg1.tileMode == TileMode::Mode7 && !ppu.lines[n].io.displayDisable && ( \
+    (ppu.lines[n].io.bg1.aboveEnable || ppu.lines[n].io.bg1.belowEnable) \
+  ))
+  for(uint y = Line::start; y < Line::start + Line::count; y++) {
+    int y_a = -1;
+    int y_b = -1;
+    if(ppu.hdPerspective()) {
+      //find the mode 7 line group this line is in and use its interpolation lines
+      for(int i : range(ppu.mode7LineGroups.count)) {
+        if(y >= ppu.mode7LineGroups.startLine[i] && y <= ppu.mode7LineGroups.endLine[i]) {
+          y_a = ppu.mode7LineGroups.startLerpLine[i];
+          y_b = ppu.mode7LineGroups.endLerpLine[i];
+          break;
+        }
+      }
+    }
+    if(y_a == -1 || y_b == -1) {
+      //if perspective correction is disabled or the group was detected as non-perspective, use the neighboring lines
+      y_a = y;
+      y_b = y;
+      if(y_a >   1 && isLineMode7(y_a)) y_a--;
+      if(y_b < 239 && isLineMode7(y_b)) y_b++;
+    }
+
+    auto& mode7a = ppu.lines[y_a].io.mode7;
+    auto& mode7b = ppu.lines[y_b].io.mode7;
+    ppu.mode7Endpoints[y] = {
+      y_a, y_b,
+      (float)(int16)mode7a.a, (float)(int16)mode7a.b, (float)(int16)mode7a.c, (float)(int16)mode7a.d,
+      (float)(int16)mode7b.a, (float)(int16)mode7b.b, (float)(int16)mode7b.c, (float)(int16)mode7b.d,
+    };
+  }
+  #undef isLineMode7
+}
+
 auto PPU::Line::renderMode7HD(PPU::IO::Background& self, uint8 source) -> void {
   const bool extbg = source == Source::BG2;
   bool mosSing = self.mosaicEnable && io.mosaic.size != 1 && ppu.hdMosaic() == 1;
   const uint sampScale = mosSing ? 1 : ppu.hdSupersample();
   const uint scale = mosSing ? 1 : ppu.hdScale() * sampScale;
 
+  //the supersampling sums and the sampled rows are kept in the thread's scratch buffers
+  const uint width = 256+2*ppufast.widescreen();
   int sampSize = sampScale < 2 ? 0 : (256+2*ppu.widescreen()) * 4 * scale/sampScale;
-  uint *sampTmp = new uint[sampSize];
+  scratch->resizeMode7(width * scale, sampSize);
+  uint* sampTmp = scratch->accumulators;
   memory::fill<uint>(sampTmp, sampSize);
 
-  Pixel  pixel;
-  Pixel* above = &this->above[0];
-  Pixel* below = &this->below[0];
-
-  //find the first and last scanline for interpolation
-  int y_a = -1;
-  int y_b = -1;
-  #define isLineMode7(n) (ppu.lines[n].io.bg1.tileMode == TileMode::Mode7 && !ppu.lines[n].io.displayDisable && ( \
-    (ppu.lines[n].io.bg1.aboveEnable || ppu.lines[n].io.bg1.belowEnable) \
-  ))
-  if(ppu.hdPerspective()) {
-    //find the mode 7 line group this line is in and use its interpolation lines
-    for(int i : range(ppu.mode7LineGroups.count)) {
-      if(y >= ppu.mode7LineGroups.startLine[i] && y <= ppu.mode7LineGroups.endLine[i]) {
-        y_a = ppu.mode7LineGroups.startLerpLine[i];
-        y_b = ppu.mode7LineGroups.endLerpLine[i];
-        break;
-      }
-    }
-  }
-  if(y_a == -1 || y_b == -1) {
-    //if perspective correction is disabled or the group was detected as non-perspective, use the neighboring lines
-    y_a = y;
-    y_b = y;
-    if(y_a >   1 && isLineMode7(y_a)) y_a--;
-    if(y_b < 239 && isLineMode7(y_b)) y_b++;
-  }
-  #undef isLineMode7
-
-  Line line_a = ppu.lines[y_a];
-  float a_a = (int16)line_a.io.mode7.a;
-  float b_a = (int16)line_a.io.mode7.b;
-  float c_a = (int16)line_a.io.mode7.c;
-  float d_a = (int16)line_a.io.mode7.d;
+  Pixel pixel;
+  uint n = 0;  //the next sub-pixel of above and below
 
-  Line line_b = ppu.lines[y_b];
-  float a_b = (int16)line_b.io.mode7.a;
-  float b_b = (int16)line_b.io.mode7.b;
-  float c_b = (int16)line_b.io.mode7.c;
-  float d_b = (int16)line_b.io.mode7.d;
+  auto& endpoints = ppu.mode7Endpoints[y];
+  int y_a = endpoints.y_a;
+  int y_b = endpoints.y_b;
+  float a_a = endpoints.a_a, b_a = endpoints.b_a, c_a = endpoints.c_a, d_a = endpoints.d_a;
+  float a_b = endpoints.a_b, b_b = endpoints.b_b, c_b = endpoints.c_b, d_b = endpoints.d_b;
 
   int hcenter = (int13)io.mode7.x;
   int vcenter = (int13)io.mode7.y;
@@ -163,6 +171,20 @@ auto PPU::Line::renderMode7HD(PPU::IO::Background& self, uint8 source) -> void {
   renderWindow(self.window, self.window.belowEnable, windowBelow,
                ppufast.widescreen(), ppufast.strwin());
 
+  //the horizontal sub-pixel positions are the same for every row
+  auto positions = scratch->positions;
+  auto pixelXs = scratch->pixelX;
+  auto pixelYs = scratch->pixelY;
+  auto palettes = scratch->palette;
+  for(int x : range(width)) {
+    x -= ppufast.widescreen();
+    for(int xs : range(scale)) {
+      float xf = x + xs * 1.0 / scale - 0.5;
+      if(io.mode7.hflip) xf = 255 - xf;
+      positions[(x + ppufast.widescreen()) * scale + xs] = xf;
+    }
+  }
+
   auto luma = ppu.lightTable[io.displayBrightness];
   int pixelYp = INT_MIN;
   for(int ys : range(scale)) {
@@ -179,26 +201,28 @@ auto PPU::Line::renderMode7HD(PPU::IO::Background& self, uint8 source) -> void {
     float originX = (a * ht) + (b * vty) + (hcenter << 8);
     float originY = (c * ht) + (d * vty) + (vcenter << 8);
 
+    //the coordinates and palette indexes of the whole row are sampled at once
+    sampleMode7HD({
+      positions, width * scale, originX, originY, a, c, ppu.renderState.vram, io.mode7.repeat,
+      pixelXs, pixelYs, palettes
+    });
+
     int pixelXp = INT_MIN;
-    for(int x : range(256+2*ppufast.widescreen())) {
+    uint sample = 0;
+    for(int x : range(width)) {
       x -= ppufast.widescreen();
       bool doAbove = self.aboveEnable && !windowAbove[ppufast.winXad(x, false)];
       bool doBelow = self.belowEnable && !windowBelow[ppufast.winXad(x, true)];
 
       for(int xs : range(scale)) {
-        float xf = x + xs * 1.0 / scale - 0.5;
-        if(io.mode7.hflip) xf = 255 - xf;
-
-        int pixelX = (originX + a * xf) / 256;
-        int pixelY = (originY + c * xf) / 256;
+        int pixelX = pixelXs[sample];
+        int pixelY = pixelYs[sample];
+        uint palette = palettes[sample++];
 
         bool skip = false;
 
         //only compute color again when coordinates have changed
         if(pixelX != pixelXp || pixelY != pixelYp) {
-          uint tile    = io.mode7.repeat == 3 && ((pixelX | pixelY) & ~1023) ? 0 : (ppu.vram[(pixelY >> 3 & 127) * 128 + (pixelX >> 3 & 127)] & 0xff);
-          uint palette = io.mode7.repeat == 2 && ((pixelX | pixelY) & ~1023) ? 0 : (ppu.vram[(((pixelY & 7) << 3) + (pixelX & 7)) + (tile << 6)] >> 8);
-
           uint8 priority;
           if(!extbg) {
             priority = self.priority[0];
@@ -229,10 +253,9 @@ auto PPU::Line::renderMode7HD(PPU::IO::Background& self, uint8 source) -> void {
           if(self.belowEnable && !windowBelow[ppufast.winXad(x, true)]) plotBelow(x, pixel.source, pixel.priority, pixel.color);
         } else
         if(sampScale == 1) {
-          if(!skip && doAbove && (!extbg || pixel.priority > above->priority)) *above = pixel;
-          if(!skip && doBelow && (!extbg || pixel.priority > below->priority)) *below = pixel;
-          above++;
-          below++;
+          if(!skip && doAbove && (!extbg || pixel.priority > above.priority[n])) above.assign(n, pixel);
+          if(!skip && doBelow && (!extbg || pixel.priority > below.priority[n])) below.assign(n, pixel);
+          n++;
         } else {
           int p = ((((x+ppufast.widescreen())*(scale/sampScale)) + (xs/sampScale))) * 4;
           sampTmp[p] += pixel.priority;
@@ -244,10 +267,9 @@ auto PPU::Line::renderMode7HD(PPU::IO::Background& self, uint8 source) -> void {
             uint32 color = ((sampTmp[p+1] / sampScale / sampScale) << 16)
                          + ((sampTmp[p+2] / sampScale / sampScale) <<  8)
                          + ((sampTmp[p+3] / sampScale / sampScale) <<  0);
-            if(!skip && doAbove && (!extbg || priority > above->priority)) *above = {source, priority, color};
-            if(!skip && doBelow && (!extbg || priority > below->priority)) *below = {source, priority, color};
-            above++;
-            below++;
+            if(!skip && doAbove && (!extbg || priority > above.priority[n])) above.assign(n, {source, priority, color});
+            if(!skip && doBelow && (!extbg || priority > below.priority[n])) below.assign(n, {source, priority, color});
+            n++;
             sampTmp[p] = 0;
             sampTmp[p+1] = 0;
             sampTmp[p+2] = 0;
@@ -258,7 +280,6 @@ auto PPU::Line::renderMode7HD(PPU::IO::Background& self, uint8 source) -> void {
       }
     }
   }
-  delete[] sampTmp;
 }
 
 //interpolation and extrapolation
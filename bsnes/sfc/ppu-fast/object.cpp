@@ -1,3 +1,45 @@
+//builds the index for the object size selection and interlace setting of every line that shows objects
+auto PPU::Line::cacheObjects() -> void {
+  for(uint y : range(240)) {
+    auto& self = ppu.lines[y].io.obj;
+    if(self.aboveEnable || self.belowEnable) ppu.objectIndex.update(ppu.objects, self);
+  }
+}
+
+auto PPU::Line::objectSize(const PPU::IO::Object& self, bool size, ObjectItem& item) -> void {
+  if(size == 0) {
+    static const uint widths[]  = { 8,  8,  8, 16, 16, 32, 16, 16};
+    static const uint heights[] = { 8,  8,  8, 16, 16, 32, 32, 32};
+    item.width  = widths [self.baseSize];
+    item.height = heights[self.baseSize];
+    if(self.interlace && self.baseSize >= 6) item.height = 16;  //hardware quirk
+  } else {
+    static const uint widths[]  = {16, 32, 64, 32, 64, 64, 32, 32};
+    static const uint heights[] = {16, 32, 64, 32, 64, 64, 64, 32};
+    item.width  = widths [self.baseSize];
+    item.height = heights[self.baseSize];
+  }
+}
+
+auto PPU::ObjectIndex::update(const Object objects[128], const IO::Object& self) -> void {
+  uint config = ObjectIndex::config(self);
+  if(valid[config]) return;
+  valid[config] = true;
+
+  auto& index = lines[config];
+  memory::fill<uint64_t>(&index[0][0], 240 * 2);
+  for(uint n : range(128)) {
+    ObjectItem item;
+    Line::objectSize(self, objects[n].size, item);
+    uint height = item.height >> self.interlace;
+    //the rows wrap around from the bottom of the screen to the top
+    for(uint row : range(height)) {
+      uint y = objects[n].y + row & 255;
+      if(y < 240) index[y][n >> 6] |= 1ull << (n & 63);
+    }
+  }
+}
+
 auto PPU::Line::renderObject(PPU::IO::Object& self) -> void {
   if(!self.aboveEnable && !self.belowEnable) return;
   if(ppufast.wsobj() == 2) return;
@@ -16,38 +58,34 @@ auto PPU::Line::renderObject(PPU::IO::Object& self) -> void {
   for(uint n : range(ppu.ItemLimit)) items[n].valid = false;
   for(uint n : range(ppu.TileLimit)) tiles[n].valid = false;
 
-  for(uint n : range(128)) {
-    ObjectItem item{true, uint8_t(self.first + n & 127)};
-    const auto& object = ppu.objects[item.index];
-
-    if(object.size == 0) {
-      static const uint widths[]  = { 8,  8,  8, 16, 16, 32, 16, 16};
-      static const uint heights[] = { 8,  8,  8, 16, 16, 32, 32, 32};
-      item.width  = widths [self.baseSize];
-      item.height = heights[self.baseSize];
-      if(self.interlace && self.baseSize >= 6) item.height = 16;  //hardware quirk
-    } else {
-      static const uint widths[]  = {16, 32, 64, 32, 64, 64, 32, 32};
-      static const uint heights[] = {16, 32, 64, 32, 64, 64, 64, 32};
-      item.width  = widths [self.baseSize];
-      item.height = heights[self.baseSize];
+  //the objects on this line (see cacheObjects), in OAM order starting from the first object
+  uint8 candidates[128];
+  uint candidateCount = 0;
+  auto& index = ppu.objectIndex.lines[ObjectIndex::config(self)][y];
+  for(uint pass : range(2)) {
+    for(uint word : range(2)) {
+      for(uint64_t bits = index[word]; bits; bits &= bits - 1) {
+        uint n = word << 6 | __builtin_ctzll(bits);
+        if((n >= self.first) != pass) candidates[candidateCount++] = n;
+      }
     }
+  }
+
+  for(uint n : range(candidateCount)) {
+    ObjectItem item{true, candidates[n]};
+    const auto& object = ppu.renderState.objects[item.index];
+    objectSize(self, object.size, item);
 
     if((wsobj == 0 || wsobj == 3) && object.x > 256 && object.x + item.width - 1 < 512) continue;
-    uint height = item.height >> self.interlace;
-    if((y >= object.y && y < object.y + height)
-    || (object.y + height >= 256 && y < (object.y + height & 255))
-    ) {
-      if(itemCount++ >= ppu.ItemLimit) break;
-      items[itemCount - 1] = item;
-    }
+    if(itemCount++ >= ppu.ItemLimit) break;
+    items[itemCount - 1] = item;
   }
 
   for(int n : reverse(range(ppu.ItemLimit))) {
     const auto& item = items[n];
     if(!item.valid) continue;
 
-    const auto& object = ppu.objects[item.index];
+    const auto& object = ppu.renderState.objects[item.index];
     uint tileWidth = item.width >> 3;
     int x = object.x;
     int y = this->y - object.y & 0xff;
@@ -89,16 +127,16 @@ auto PPU::Line::renderObject(PPU::IO::Object& self) -> void {
       uint mirrorX = !object.hflip ? tileX : tileWidth - 1 - tileX;
       uint address = tiledataAddress + ((characterY + (characterX + mirrorX & 15)) << 4);
       address = ppu.vramExt((address & 0xfff0 /*0x7ff0*/) + (y & 7));
-      tile.data  = ppu.vram[address + 0] <<  0;
-      tile.data |= ppu.vram[address + 8] << 16;
+      tile.data = ppu.tileCache.row(TileMode::BPP4, address);
+      tileReads++;
 
       if(tileCount++ >= ppu.TileLimit) break;
       tiles[tileCount - 1] = tile;
     }
   }
 
-  ppu.io.obj.rangeOver |= itemCount > ppu.ItemLimit;
-  ppu.io.obj.timeOver  |= tileCount > ppu.TileLimit;
+  if(itemCount > ppu.ItemLimit) ppu.overflow.range = true;
+  if(tileCount > ppu.TileLimit) ppu.overflow.time = true;
 
   uint8_t palette[512] = {};//
   uint8_t priority[512] = {};//
@@ -111,11 +149,7 @@ auto PPU::Line::renderObject(PPU::IO::Object& self) -> void {
     for(uint x : range(8)) {
       tileX &= 511;
       //if(tileX < 256) {
-        uint color, shift = tile.hflip ? x : 7 - x;
-        color  = tile.data >> shift +  0 & 1;
-        color += tile.data >> shift +  7 & 2;
-        color += tile.data >> shift + 14 & 4;
-        color += tile.data >> shift + 21 & 8;
+        uint color = tile.data >> (tile.hflip ? 7 - x : x) * 8 & 0xff;
         if(color) {
           palette[tileX] = tile.palette + color;
           priority[tileX] = self.priority[tile.priority];
@@ -193,7 +227,11 @@ auto PPU::writeObject(uint10 address, uint8 data) -> void {
     uint n = address >> 2;  //object#
     address &= 3;
     if(address == 0) { objects[n].x = objects[n].x & 0x100 | data; return; }
-    if(address == 1) { objects[n].y = data + 1; return; }  //+1 => rendering happens one scanline late
+    if(address == 1) {
+      if(objects[n].y != uint8(data + 1)) objectIndex.invalidate();
+      objects[n].y = data + 1;  //+1 => rendering happens one scanline late
+      return;
+    }
     if(address == 2) { objects[n].character = data; return; }
     objects[n].nameselect = data >> 0 & 1;
     objects[n].palette    = data >> 1 & 7;
@@ -202,6 +240,8 @@ auto PPU::writeObject(uint10 address, uint8 data) -> void {
     objects[n].vflip      = data >> 7 & 1;
   } else {
     uint n = (address & 0x1f) << 2;  //object#
+    uint8 sizes = objects[n + 0].size << 1 | objects[n + 1].size << 3 | objects[n + 2].size << 5 | objects[n + 3].size << 7;
+    if(sizes != (data & 0xaa)) objectIndex.invalidate();
     objects[n + 0].x = objects[n + 0].x & 0xff | data << 8 & 0x100;
     objects[n + 1].x = objects[n + 1].x & 0xff | data << 6 & 0x100;
     objects[n + 2].x = objects[n + 2].x & 0xff | data << 4 & 0x100;
@@ -1,5 +1,10 @@
 #include <sfc/sfc.hpp>
 
+#if (defined(ARCHITECTURE_AMD64) || defined(ARCHITECTURE_X86)) && (defined(COMPILER_GCC) || defined(COMPILER_CLANG))
+  #define PPU_FAST_SIMD
+  #include <immintrin.h>
+#endif
+
 namespace SuperFamicom {
 
 PPU& ppubase = ppu;
@@ -8,28 +13,33 @@ PPU& ppubase = ppu;
 #define ppu ppufast
 
 PPU ppu;
+#include "tilecache.cpp"
 #include "io.cpp"
 #include "line.cpp"
+#include "gradient.cpp"
 #include "background.cpp"
 #include "mode7.cpp"
 #include "mode7hd.cpp"
+#include "mode7hd-sample.cpp"
+#include "composite.cpp"
 #include "object.cpp"
 #include "window.cpp"
 #include "serialization.cpp"
 
-auto PPU::interlace() const -> bool { return ppubase.display.interlace; }
-auto PPU::overscan() const -> bool { return ppubase.display.overscan; }
+auto PPU::interlace() const -> bool { return renderState.interlace; }
+auto PPU::overscan() const -> bool { return renderState.overscan; }
 auto PPU::vdisp() const -> uint { return ppubase.display.vdisp; }
-auto PPU::hires() const -> bool { return latch.hires; }
-auto PPU::hd() const -> bool { return latch.hd; }
-auto PPU::ss() const -> bool { return latch.ss; }
+auto PPU::hires() const -> bool { return renderState.hires; }
+auto PPU::hd() const -> bool { return renderState.hd; }
+auto PPU::ss() const -> bool { return renderState.ss; }
 #undef ppu
 auto PPU::hdScale() const -> uint { return configuration.hacks.ppu.mode7.scale; }
 auto PPU::hdPerspective() const -> uint { return configuration.hacks.ppu.mode7.perspective; }
 auto PPU::hdSupersample() const -> uint { return configuration.hacks.ppu.mode7.supersample; }
 auto PPU::hdMosaic() const -> uint { return configuration.hacks.ppu.mode7.mosaic; }
 auto PPU::widescreen() const -> uint { return wsExt; }
-auto PPU::widescreenRaw() const -> uint { return !hd() || configuration.hacks.ppu.mode7.wsMode == 0 ? 0 : configuration.hacks.ppu.mode7.widescreen; }
+auto PPU::widescreenRaw() const -> uint { return !hd() ? 0 : widescreenHd(); }
+auto PPU::widescreenHd() const -> uint { return configuration.hacks.ppu.mode7.wsMode == 0 ? 0 : configuration.hacks.ppu.mode7.widescreen; }
 auto PPU::wsbg(uint bg) const -> uint {
   if (bg == Source::BG1) return configuration.hacks.ppu.mode7.wsbg1;
   if (bg == Source::BG2) return configuration.hacks.ppu.mode7.wsbg2;
@@ -37,22 +47,20 @@ auto PPU::wsbg(uint bg) const -> uint {
   if (bg == Source::BG4) return configuration.hacks.ppu.mode7.wsbg4;
   return 0; }
 auto PPU::wsobj() const -> uint { return configuration.hacks.ppu.mode7.wsobj; }
+auto PPU::winIgnored(bool bel) const -> bool {
+  return configuration.hacks.ppu.mode7.igwin != 0 && (configuration.hacks.ppu.mode7.igwin >= 3
+      || configuration.hacks.ppu.mode7.igwin >= 2 && ((bel ? renderState.belowMask : renderState.aboveMask) == 0)
+      || configuration.hacks.ppu.mode7.igwin >= 1 && ((bel ? renderState.belowMask : renderState.aboveMask) == 2)); }
 auto PPU::winXad(uint x, bool bel) const -> uint {
-  return ((configuration.hacks.ppu.mode7.igwin != 0 && (configuration.hacks.ppu.mode7.igwin >= 3
-       || configuration.hacks.ppu.mode7.igwin >= 2 && ((bel ? io.col.window.belowMask : io.col.window.aboveMask) == 0)
-       || configuration.hacks.ppu.mode7.igwin >= 1 && ((bel ? io.col.window.belowMask : io.col.window.aboveMask) == 2)))
-    ? configuration.hacks.ppu.mode7.igwinx : x) + widescreen(); }
+  return (winIgnored(bel) ? configuration.hacks.ppu.mode7.igwinx : x) + widescreen(); }
 auto PPU::winXadHd(uint x, bool bel) const -> uint {
-  return (configuration.hacks.ppu.mode7.igwin != 0 && (configuration.hacks.ppu.mode7.igwin >= 3
-       || configuration.hacks.ppu.mode7.igwin >= 2 && ((bel ? io.col.window.belowMask : io.col.window.aboveMask) == 0)
-       || configuration.hacks.ppu.mode7.igwin >= 1 && ((bel ? io.col.window.belowMask : io.col.window.aboveMask) == 2)))
-    ? configuration.hacks.ppu.mode7.igwinx * PPU::hdScale() : x; }
+  return winIgnored(bel) ? configuration.hacks.ppu.mode7.igwinx * PPU::hdScale() : x; }
 auto PPU::strwin() const -> bool { return configuration.hacks.ppu.mode7.strwin; }
 auto PPU::vramExt(uint addr) const -> uint { return addr & configuration.hacks.ppu.mode7.vramExt; }
 auto PPU::bgGrad() const -> uint { return !hd() ? 0 : configuration.hacks.ppu.mode7.bgGrad; }
 auto PPU::windRad() const -> uint { return !hd() ? 0 : configuration.hacks.ppu.mode7.windRad; }
 auto PPU::wsOverrideCandidate() const -> bool { return configuration.hacks.ppu.mode7.wsMode == 1; }
-auto PPU::wsOverride() const -> bool { return mode7LineGroups.count < 1 && wsOverrideCandidate(); }
+auto PPU::wsOverride() const -> bool { return renderState.wsOverride && wsOverrideCandidate(); }
 auto PPU::wsBgCol() const -> bool { return configuration.hacks.ppu.mode7.wsBgCol == 2
                                             || configuration.hacks.ppu.mode7.wsBgCol == 1 && wsOverride(); }
 auto PPU::wsHandling() const -> uint { return configuration.hacks.ppu.mode7.wsHandling; }
@@ -60,6 +68,13 @@ auto PPU::wsMarker() const -> uint { return configuration.hacks.ppu.mode7.wsMark
 auto PPU::wsMarkerAlpha() const -> uint { return configuration.hacks.ppu.mode7.wsMarkerAlpha; }
 auto PPU::deinterlace() const -> bool { return configuration.hacks.ppu.deinterlace; }
 auto PPU::renderCycle() const -> uint { return configuration.hacks.ppu.renderCycle; }
+auto PPU::renderThreads() const -> uint {
+  uint threads = configuration.hacks.ppu.renderThreads;
+  return threads ? threads - 1 : WorkerPool::automatic();
+}
+//pipelining needs at least one worker thread to render in the background
+auto PPU::renderPipeline() const -> bool { return configuration.hacks.ppu.renderPipeline && renderThreads(); }
+auto PPU::renderIncremental() const -> bool { return configuration.hacks.ppu.renderIncremental && renderThreads() && !pipelined; }
 auto PPU::noVRAMBlocking() const -> bool { return configuration.hacks.ppu.noVRAMBlocking; }
 
 auto PPU::ensureTemporalBuffer(uint width, uint scale, uint interlaceFactor) -> void {
@@ -108,10 +123,10 @@ PPU::PPU() {
 }
 
 PPU::~PPU() {
+  renderWait();
   delete[] output;
   delete[] wsTemporalAbove;
   delete[] wsTemporalBelow;
-  for(uint l : range(16)) delete[] lightTable[l];
 }
 
 auto PPU::synchronizeCPU() -> void {
@@ -154,6 +169,13 @@ auto PPU::main() -> void {
 
 auto PPU::scanline() -> void {
   if(vcounter() == 0) {
+    if(pipelined != renderPipeline()) {
+      renderWait();
+      pipelined = renderPipeline();
+      if(pipelined) pipeline = new Pipeline;
+      if(!pipelined) pipeline.reset();
+    }
+
     if(latch.overscan && !io.overscan) {
       //when disabling overscan, clear the overscan area that won't be rendered to:
       for(uint y = 1; y <= 240; y++) {
@@ -190,38 +212,87 @@ auto PPU::scanline() -> void {
 }
 
 auto PPU::refresh() -> void {
+  lastRenderTime = renderTime;
+  renderTime = 0;
+  #if defined(BUILD_DEBUG)
+  //the render buffers are sized once per scale and widescreen setting: any other allocation is a regression
+  if(auto count = Scratch::allocations.exchange(0)) print("PPU: ", count, " render buffer allocations\n");
+  #endif
+
   if(system.frameCounter == 0 && !system.runAhead) {
-    auto output = this->output;
-    uint pitch, width, height;
-    if(!hd()) {
-      pitch  = 512 << !interlace();
-      width  = 256 << hires();
-      height = 240 << interlace();
-    } else {
-      pitch  = (256+2*widescreen()) * hdScale();
-      width  = (256+2*widescreen()) * hdScale();
-      height = 240 * hdScale();
-    }
+    RenderedFrame current{true, renderState, output, wsExt, hdScale()};
+    //when pipelined, the previous frame is presented; its rendering completed during this frame
+    auto& source = pipelined ? pipeline->rendered : current;
+    if(source.valid) present(source);
+    source.valid = false;
+  }
+  videoTargetRequested = false;
+  if(system.frameCounter++ >= system.frameSkip) system.frameCounter = 0;
+}
 
-    //clear the areas of the screen that won't be rendered:
-    //previous video frames may have drawn data here that would now be stale otherwise.
-    if(!latch.overscan && pitch != frame.pitch && width != frame.width && height != frame.height) {
-      for(uint y : range(240)) {
-        if(y >= 8 && y <= 230) continue;  //these scanlines are always rendered.
-        auto output = this->output + (!hd() ? (y * 1024 + (interlace() && field() ? 512 : 0)) : (y * 256 * hdScale() * hdScale()));
-        auto width = (!hd() ? (!hires() ? 256 : 512) : (256 * hdScale() * hdScale()));
-        memory::fill<uint32>(output, width);
-      }
+auto PPU::present(const RenderedFrame& source) -> void {
+  auto& state = source.state;
+  auto output = source.output;
+  uint scale = source.scale;
+  uint pitch, width, height;
+  if(!state.hd) {
+    pitch  = 512 << !state.interlace;
+    width  = 256 << state.hires;
+    height = 240 << state.interlace;
+  } else {
+    pitch  = (256+2*source.wsExt) * scale;
+    width  = (256+2*source.wsExt) * scale;
+    height = 240 * scale;
+  }
+
+  //clear the areas of the screen that won't be rendered:
+  //previous video frames may have drawn data here that would now be stale otherwise.
+  if(!state.target && !state.overscan && pitch != frame.pitch && width != frame.width && height != frame.height) {
+    for(uint y : range(240)) {
+      if(y >= 8 && y <= 230) continue;  //these scanlines are always rendered.
+      auto line = output + (!state.hd ? (y * 1024 + (state.interlace && state.field ? 512 : 0)) : (y * 256 * scale * scale));
+      auto width = (!state.hd ? (!state.hires ? 256 : 512) : (256 * scale * scale));
+      memory::fill<uint32>(line, width);
     }
+  }
 
+  if(auto& target = state.target) {
+    //the frame was rendered directly into the frontend's memory
+    platform->videoFrame(target.data, target.pitch * sizeof(uint32), width, height, scale);
+  } else {
     if(auto device = controllerPort2.device) device->draw(output, pitch * sizeof(uint32), width, height);
-    platform->videoFrame(output, pitch * sizeof(uint32), width, height, hd() ? hdScale() : 1);
+    platform->videoFrame(output, pitch * sizeof(uint32), width, height, state.hd ? scale : 1);
+  }
 
-    frame.pitch  = pitch;
-    frame.width  = width;
-    frame.height = height;
+  frame.pitch  = pitch;
+  frame.width  = width;
+  frame.height = height;
+}
+
+//asks the frontend for memory to render the HD lines of the next presented frame into
+auto PPU::requestVideoTarget() -> void {
+  videoTargetRequested = true;
+  videoTarget = {};
+  videoTargetWidth = 0;
+  if(!hdScale() || pipelined) return;
+  //light guns draw their cursor over the whole frame
+  auto port2 = settings.controllerPort2;
+  if(port2 == ID::Device::SuperScope || port2 == ID::Device::Justifier || port2 == ID::Device::Justifiers) return;
+
+  uint scale = hdScale();
+  uint width = (256 + 2 * HdToolkit::determineWsExt(widescreenHd(),
+        configuration.video.overscan, configuration.video.aspectCorrection)) * scale;
+  if(videoTarget = platform->videoTarget(width, 240 * scale, scale)) videoTargetWidth = width;
+}
+
+//completes a pipelined render in progress, making its frame ready to be presented
+auto PPU::renderWait() -> void {
+  workers.wait();
+  for(auto& line : lines) tileCache.reads += line.tileReads, line.tileReads = 0;
+  if(pipeline && pipeline->rendering.valid) {
+    pipeline->rendered = pipeline->rendering;
+    pipeline->rendering.valid = false;
   }
-  if(system.frameCounter++ >= system.frameSkip) system.frameCounter = 0;
 }
 
 auto PPU::load() -> bool {
@@ -229,6 +300,8 @@ auto PPU::load() -> bool {
 }
 
 auto PPU::power(bool reset) -> void {
+  renderWait();
+  if(pipeline) pipeline->rendered.valid = false;
   PPUcounter::reset();
   memory::fill<uint16>(output, 256 * 61440);
   clearTemporalBuffer();
@@ -241,7 +314,15 @@ auto PPU::power(bool reset) -> void {
     for(auto& word : vram) word = 0x0000;
     for(auto& color : cgram) color = 0x0000;
     for(auto& object : objects) object = {};
+    objectIndex.invalidate();
+    vramDirty.markAll();
+    cgramDirty.markAll();
+    tileCache.invalidate(0, 65536);
   }
+  overflow = {};
+  incremental.reset();
+  videoTarget = {};
+  videoTargetRequested = false;
 
   latch = {};
   io = {};
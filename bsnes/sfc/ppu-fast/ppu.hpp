@@ -19,10 +19,12 @@ struct PPU : PPUcounter {
   alwaysinline auto hdMosaic() const -> uint;
   alwaysinline auto widescreen() const -> uint;
   alwaysinline auto widescreenRaw() const -> uint;
+  alwaysinline auto widescreenHd() const -> uint;
   alwaysinline auto wsbg(uint bg) const -> uint;
   alwaysinline auto wsobj() const -> uint;
   alwaysinline auto winXad(uint x, bool bel) const -> uint;
   alwaysinline auto winXadHd(uint x, bool bel) const -> uint;
+  alwaysinline auto winIgnored(bool bel) const -> bool;
   alwaysinline auto strwin() const -> bool;
   alwaysinline auto vramExt(uint addr) const -> uint;
   alwaysinline auto bgGrad() const -> uint;
@@ -35,6 +37,9 @@ struct PPU : PPUcounter {
   alwaysinline auto wsMarkerAlpha() const -> uint;
   alwaysinline auto deinterlace() const -> bool;
   alwaysinline auto renderCycle() const -> uint;
+  alwaysinline auto renderThreads() const -> uint;
+  alwaysinline auto renderPipeline() const -> bool;
+  alwaysinline auto renderIncremental() const -> bool;
   alwaysinline auto noVRAMBlocking() const -> bool;
   auto ensureTemporalBuffer(uint width, uint scale, uint interlaceFactor) -> void;
   auto clearTemporalBuffer() -> void;
@@ -49,8 +54,12 @@ struct PPU : PPUcounter {
   auto main() -> void;
   auto scanline() -> void;
   auto refresh() -> void;
+  struct RenderedFrame;
+  auto present(const RenderedFrame&) -> void;
+  auto requestVideoTarget() -> void;
   auto load() -> bool;
   auto power(bool reset) -> void;
+  auto renderWait() -> void;
 
   //serialization.cpp
   auto serialize(serializer&) -> void;
@@ -257,7 +266,7 @@ public:
     uint8 priority = 0;
     uint8 palette = 0;
     bool hflip = 0;
-    uint32 data = 0;
+    uint64_t data = 0;  //decoded row (see TileCache)
   };
 
   struct Pixel {
@@ -266,6 +275,48 @@ public:
     uint32 color = 0;
   };
 
+  //a line's pixels, stored as separate planes of sources, priorities and colors
+  struct Pixels {
+    alwaysinline auto operator[](uint x) const -> const Pixel { return {source[x], priority[x], color[x]}; }
+    alwaysinline auto assign(uint x, Pixel pixel) -> void {
+      source[x] = pixel.source;
+      priority[x] = pixel.priority;
+      color[x] = pixel.color;
+    }
+
+    uint8* source = nullptr;
+    uint8* priority = nullptr;
+    uint32* color = nullptr;
+  };
+
+  //buffers that a line is composed in, before its output. every rendering thread has its own set,
+  //sized for one line at the current scale and widescreen extension, and only reallocated when those change.
+  //they are the only memory the renderer allocates, so rendering a frame does not allocate once they are sized.
+  struct Scratch {
+    ~Scratch();
+    auto resize(uint size) -> void;
+    auto resizeMode7(uint samples, uint accumulators) -> void;
+
+    Pixels above;
+    Pixels below;
+    bool* windowAbove = nullptr;
+    bool* windowBelow = nullptr;
+    uint size = 0;
+
+    //HD mode 7: a row of sub-pixels, and the supersampling sums (these only ever grow)
+    float* positions = nullptr;
+    int* pixelX = nullptr;
+    int* pixelY = nullptr;
+    uint8* palette = nullptr;
+    uint samples = 0;
+    uint* accumulators = nullptr;
+    uint accumulatorSize = 0;
+
+    #if defined(BUILD_DEBUG)
+    static std::atomic<uint> allocations;  //reported and reset by refresh()
+    #endif
+  };
+
   //io.cpp
   auto latchCounters(uint hcounter, uint vcounter) -> void;
   auto latchCounters() -> void;
@@ -292,14 +343,19 @@ public:
 
   uint16 vram[32 * 1024 * 2] = {}; //0-ffff
   uint16 cgram[256] = {};
+  DirtyPages vramDirty{sizeof(vram)};
+  DirtyPages cgramDirty{sizeof(cgram)};
   Object objects[128] = {};
 
+  //sprite overflow flags raised by the renderer; applied to io.obj once rendering completes
+  struct Overflow {
+    bool range = 0;
+    bool time = 0;
+  } overflow;
+
   //[unserialized]
   uint32* output = {};
-  uint32* lightTable[16] = {};
-  uint luminance = 222;
-  uint saturation = 222;
-  uint gamma = 222;
+  LightTable lightTable;
   uint wsExt = 0;
 
   Pixel* wsTemporalAbove = nullptr;
@@ -312,22 +368,153 @@ public:
   uint ItemLimit = 0;
   uint TileLimit = 0;
 
+  //object.cpp
+  //the objects whose rows cover each line, one bit per object, for each object size selection and interlace setting.
+  //OAM writes that move or resize an object invalidate it; it is rebuilt before lines are next handed to the renderer.
+  struct ObjectIndex {
+    static auto config(const IO::Object& self) -> uint { return self.baseSize << 1 | self.interlace; }
+    auto invalidate() -> void { for(auto& built : valid) built = false; }
+    auto update(const Object objects[128], const IO::Object&) -> void;
+
+    bool valid[16] = {};
+    uint64_t lines[16][240][2];
+  } objectIndex;
+
+  WorkerPool workers;
+
+  //tilecache.cpp
+  //every row of every 2bpp, 4bpp and 8bpp tile in VRAM, decoded to eight palette indices (the leftmost pixel in the low byte).
+  //VRAM writes only mark the tiles they touch: those are decoded again before lines are next handed to the renderer,
+  //once no line is being rendered, so the rows always match the VRAM the lines are rendered from.
+  struct TileCache {
+    TileCache();
+    alwaysinline auto invalidate(uint address) -> void;
+    auto invalidate(uint address, uint size) -> void;
+    auto update(const uint16* vram) -> void;
+    //address: of the first bitplane word of the row, as the tile data is read from VRAM
+    alwaysinline auto row(uint tileMode, uint address) const -> uint64_t;
+
+    uint64_t bpp2[65536];
+    uint64_t bpp4[32768];
+    uint64_t bpp8[16384];
+    uint64_t dirty[128] = {};  //one bit per 2bpp tile (eight words of VRAM)
+    uint64_t spread[256];      //bitplane byte => one bit per pixel byte
+
+    //the hit rate is at least 1 - decodes / reads
+    uint64_t reads = 0;    //rows read by the renderer, collected by renderWait()
+    uint64_t decodes = 0;  //rows decoded
+  } tileCache;
+  uint64_t renderTime = 0;      //nanoseconds spent rendering lines during the current frame
+  uint64_t lastRenderTime = 0;  //... and during the previous frame
+                                //(when pipelined, only the time the emulation thread spends staging and waiting)
+
+  //frame state read by the renderer: it is latched whenever lines are flushed,
+  //so that a pipelined render is unaffected by emulation of the following frame
+  struct RenderState {
+    bool interlace = 0;
+    bool overscan = 0;
+    bool hires = 0;
+    bool hd = 0;
+    bool ss = 0;
+    bool field = 0;
+    uint aboveMask = 0;  //color window masks (see winXad)
+    uint belowMask = 0;
+    bool wsOverride = 1;  //no mode 7 line groups were found (see cacheMode7HD)
+    const uint16* vram = nullptr;
+    const Object* objects = nullptr;
+    uint32* output = nullptr;
+    Emulator::Platform::VideoTarget target;  //HD lines displayed by the frontend are rendered here instead
+
+    auto operator!=(const RenderState& source) const -> bool {
+      return interlace != source.interlace || overscan != source.overscan
+          || hires != source.hires || hd != source.hd || ss != source.ss || field != source.field
+          || aboveMask != source.aboveMask || belowMask != source.belowMask || wsOverride != source.wsOverride
+          || vram != source.vram || objects != source.objects || output != source.output
+          || target.data != source.target.data;
+    }
+  } renderState;
+
+  struct RenderedFrame {
+    bool valid = false;
+    RenderState state;
+    uint32* output = nullptr;
+    uint wsExt = 0;
+    uint scale = 0;
+  };
+
+  //pipelined rendering: the lines of a frame are rendered by the workers
+  //while the next frame is emulated, and presented one frame later
+  struct Pipeline {
+    Pipeline() { output = new uint32_t[256 * 61440](); }
+    ~Pipeline() { delete[] output; }
+
+    uint16 vram[32 * 1024 * 2];
+    Object objects[128];
+    struct Staged {
+      IO io;
+      uint16 cgram[256];
+    } lines[240];
+    uint32* output = nullptr;  //exchanged with PPU::output each frame
+    RenderedFrame rendering;  //being rendered by the workers
+    RenderedFrame rendered;   //ready to be presented
+  };
+  unique_pointer<Pipeline> pipeline;
+  bool pipelined = false;  //latched at the start of each frame
+
+  //requested from the frontend once per presented frame (see Line::latchRenderState)
+  Emulator::Platform::VideoTarget videoTarget;
+  uint videoTargetWidth = 0;
+  bool videoTargetRequested = false;
+
+  //incremental rendering: lines are handed to the workers in chunks as soon as they are cached,
+  //using the frame state at that point; wsOverride is predicted from the previous flush
+  struct Incremental {
+    static constexpr uint Chunk = 16;
+
+    auto reset() -> void {
+      for(auto& line : rendered) line = false;
+      count = 0;
+      next = 0;
+    }
+
+    RenderState state;
+    uint wsExt = 0;
+    uint reach = 0;  //lines below each line that it blends with (see renderAhead)
+    uint next = 0;   //first line not yet handed to the workers
+    uint count = 0;  //number of lines rendered ahead of the flush
+    bool rendered[240] = {};
+  } incremental;
+
+  uint8_t renderQueue[240];  //lines being rendered by the workers
+
   struct Line {
     //line.cpp
     inline auto field() const -> bool { return fieldID; }
     static auto flush() -> void;
+    static auto flushFrame() -> void;
+    static auto latchRenderState() -> void;
+    static auto applyOverflow() -> void;
+    static auto updateLightTable() -> bool;
+    static auto renderLines(bool async) -> void;
+    static auto renderAhead() -> void;
+    static auto renderQueued(uint begin, uint end) -> void;
     auto cache() -> void;
     auto render(bool field) -> void;
 
     alwaysinline auto pixel(uint x, Pixel above, Pixel below, uint ws, uint wsm,
                             uint wsma, uint32 bgFixedColor) const -> uint32;
-    alwaysinline auto blend(uint x, uint y, bool halve) const -> uint32;
+    static alwaysinline auto blend(uint x, uint y, bool halve, bool subtract) -> uint32;
     alwaysinline auto directColor(uint paletteIndex, uint paletteColor) const -> uint32;
     alwaysinline auto plotAbove(int x, uint8 source, uint8 priority, uint32 color) -> void;
     alwaysinline auto plotBelow(int x, uint8 source, uint8 priority, uint32 color) -> void;
-    alwaysinline auto plotHD(Pixel*, int x, uint8 source, uint8 priority, uint32 color, bool hires, bool subpixel) -> void;
+    alwaysinline auto plotHD(Pixels&, int x, uint8 source, uint8 priority, uint32 color, bool hires, bool subpixel) -> void;
 
-    alwaysinline auto avgBgC(uint dist, uint offset) const -> uint32;
+    //gradient.cpp
+    static auto cacheLineStates() -> void;
+    auto fixedColorGradient(uint dist, uint32 colors[]) const -> void;
+    auto windowEdgeGradient(uint dist, int edges[][4], int counts[]) const -> void;
+    template<uint Channels, typename Fails, typename Value>
+    auto gradient(uint dist, int top, const Fails& fails, const Value& value, int sums[][Channels], int counts[]) const -> void;
 
     //background.cpp
     auto renderBackground(PPU::IO::Background&, uint8 source) -> void;
@@ -338,10 +525,48 @@ public:
 
     //mode7hd.cpp
     static auto cacheMode7HD() -> void;
+    static auto cacheMode7Endpoints() -> void;
     auto renderMode7HD(PPU::IO::Background&, uint8 source) -> void;
     alwaysinline auto lerp(float pa, float va, float pb, float vb, float pr) -> float;
 
+    //mode7hd-sample.cpp
+    struct Mode7Span {
+      const float* xf;  //horizontal screen position of each sub-pixel
+      uint count;
+      float originX, originY, a, c;
+      const uint16* vram;
+      uint repeat;
+      int* pixelX;      //output: position on the mode 7 plane
+      int* pixelY;
+      uint8* palette;   //output: palette index found there (including the extbg priority bit)
+    };
+    static auto sampleMode7HD(const Mode7Span&) -> void;
+
+    //composite.cpp
+    struct CompositeSpan {
+      uint count;
+      const uint8* aboveSource;
+      const uint32* aboveColor;
+      const uint8* belowSource;
+      const uint32* belowColor;
+      const bool* clip;       //the color window that clips the above color to black: per pixel, or one for all (stride 0)
+      uint clipStride;
+      const bool* math;       //likewise, for the color window that color math applies within
+      uint mathStride;
+      const bool* halve;      //the color window of each pixel, for halving
+      uint8 enable[16];       //color math enable of each source
+      bool blendMode;
+      bool halveEnable;
+      bool subtract;
+      uint32 fixedColor;
+      uint32* output;
+    };
+    auto compositeSpan(const Pixels& above, const Pixels& below, uint x, uint count, uint32 fixedColor, uint32* output) const -> CompositeSpan;
+    static auto composite(const CompositeSpan&) -> void;
+
     //object.cpp
+    static auto cacheObjects() -> void;
+    static auto objectSize(const PPU::IO::Object&, bool size, ObjectItem&) -> void;
     auto renderObject(PPU::IO::Object&) -> void;
 
     //window.cpp
@@ -361,11 +586,15 @@ public:
     ObjectItem items[128];  //32 on real hardware
     ObjectTile tiles[128];  //34 on real hardware; 1024 max (128 * 64-width tiles)
 
-    Pixel *above = new Pixel[61440];
-    Pixel *below = new Pixel[61440];
+    //the scratch buffers of the thread rendering the line
+    Scratch* scratch = nullptr;
+    Pixels above;
+    Pixels below;
 
-    bool *windowAbove = new bool[61440] ;
-    bool *windowBelow = new bool[61440] ;
+    bool* windowAbove = nullptr;
+    bool* windowBelow = nullptr;
+
+    uint tileReads = 0;  //rows read from the tile cache, until collected by renderWait()
 
     //flush()
     static uint start;
@@ -389,6 +618,21 @@ public:
     int startLerpLine[240];
     int endLerpLine[240];
   } mode7LineGroups;
+
+  //the lines each HD mode 7 line interpolates its matrix between, and their matrix values (see cacheMode7Endpoints)
+  struct Mode7Endpoints {
+    int y_a, y_b;
+    float a_a, b_a, c_a, d_a;
+    float a_b, b_b, c_b, d_b;
+  } mode7Endpoints[240];
+
+  //the state of each line that HD fixed color gradients and window smoothing compare neighboring lines by (see cacheLineStates)
+  struct LineState {
+    uint64_t colorMath;  //color math and background modes: the fixed color is only blended across lines where these match
+    uint64_t window;     //color window configuration: likewise for the window edges
+    uint16 fixedColor;
+    int edges[4];        //oneLeft, oneRight, twoLeft, twoRight
+  } lineStates[240];
 };
 
 extern PPU ppufast;
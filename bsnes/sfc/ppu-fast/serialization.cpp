@@ -1,15 +1,27 @@
 auto PPU::serialize(serializer& s) -> void {
+  renderWait();
   ppubase.Thread::serialize(s);
   PPUcounter::serialize(s);
 
   latch.serialize(s);
   io.serialize(s);
-  s.array(vram);
-  s.array(cgram);
+  if(s.mode() == serializer::Load) {
+    for(uint address = 0; address < sizeof(vram); address += DirtyPages::PageSize) {
+      if(vramDirty.transfers(s, address)) tileCache.invalidate(address >> 1, DirtyPages::PageSize >> 1);
+    }
+  }
+  vramDirty.serialize(s, vram, sizeof(vram) / sizeof(uint16));
+  cgramDirty.serialize(s, cgram, sizeof(cgram) / sizeof(uint16));
   for(auto& object : objects) object.serialize(s);
+  if(s.mode() == serializer::Load) objectIndex.invalidate();
+  s.integer(overflow.range);
+  s.integer(overflow.time);
 
   Line::start = 0;
   Line::count = 0;
+  incremental.reset();
+  //a frame rendered before the state was loaded no longer belongs to this timeline
+  if(s.mode() == serializer::Load && pipeline) pipeline->rendered.valid = false;
 }
 
 auto PPU::Latch::serialize(serializer& s) -> void {
@@ -0,0 +1,51 @@
+PPU::TileCache::TileCache() {
+  for(uint byte : range(256)) {
+    spread[byte] = 0;
+    for(uint x : range(8)) spread[byte] |= (uint64_t)(byte >> 7 - x & 1) << x * 8;
+  }
+  invalidate(0, 65536);
+}
+
+alwaysinline auto PPU::TileCache::invalidate(uint address) -> void {
+  dirty[address >> 9 & 127] |= 1ull << (address >> 3 & 63);
+}
+
+auto PPU::TileCache::invalidate(uint address, uint size) -> void {
+  for(uint offset = 0; offset < size; offset += 8) invalidate(address + offset);
+}
+
+//decodes the tiles written since the last update; called while no line is being rendered
+auto PPU::TileCache::update(const uint16* vram) -> void {
+  auto decode = [&](uint64_t* rows, uint address, uint planes) {
+    for(uint y : range(8)) {
+      uint64_t row = 0;
+      for(uint plane = 0; plane < planes; plane += 2) {
+        uint16 data = vram[address + y + (plane << 2)];
+        row |= spread[data & 0xff] << plane + 0;
+        row |= spread[data >>   8] << plane + 1;
+      }
+      rows[y] = row;
+    }
+    decodes += 8;
+  };
+
+  //the 4bpp and 8bpp tiles span two and four 2bpp tiles: each is decoded once, however many of those were written
+  uint last4 = ~0u, last8 = ~0u;
+  for(uint word : range(128)) {
+    if(!dirty[word]) continue;
+    for(uint bit : range(64)) {
+      if(!(dirty[word] >> bit & 1)) continue;
+      uint tile = word << 6 | bit;
+      decode(bpp2 + (tile << 3), tile << 3, 2);
+      if(tile >> 1 != last4) decode(bpp4 + (tile >> 1 << 3), tile >> 1 << 4, 4), last4 = tile >> 1;
+      if(tile >> 2 != last8) decode(bpp8 + (tile >> 2 << 3), tile >> 2 << 5, 8), last8 = tile >> 2;
+    }
+    dirty[word] = 0;
+  }
+}
+
+alwaysinline auto PPU::TileCache::row(uint tileMode, uint address) const -> uint64_t {
+  if(tileMode == TileMode::BPP2) return bpp2[address & 0xffff];
+  if(tileMode == TileMode::BPP4) return bpp4[(address & 0xfff0) >> 1 | (address & 7)];
+  return bpp8[(address & 0xffe0) >> 2 | (address & 7)];
+}
@@ -0,0 +1,104 @@
+LightTable::LightTable() {
+  data = new uint32[16 << 15]();
+}
+
+LightTable::~LightTable() {
+  delete[] data;
+}
+
+auto LightTable::matches(uint luminance, uint saturation, uint gamma) const -> bool {
+  return this->luminance == luminance && this->saturation == saturation && this->gamma == gamma;
+}
+
+//linear ramp, used by the accurate PPU
+auto LightTable::generate() -> void {
+  for(uint l : range(16)) {
+    double luma = (double)l * 8.0 / 15.0;
+    for(uint r : range(32)) {
+      for(uint g : range(32)) {
+        for(uint b : range(32)) {
+          uint ar = (luma * r + 0.5);
+          uint ag = (luma * g + 0.5);
+          uint ab = (luma * b + 0.5);
+          data[l << 15 | r << 10 | g << 5 | b << 0] = ab << 16 | ag << 8 | ar << 0;
+        }
+      }
+    }
+  }
+  luminance = saturation = gamma = ~0;
+}
+
+//the adjustments only depend on the color, so they are computed once per color rather than once per brightness level.
+//without a saturation adjustment, each channel only depends on its own component, and is computed once per component.
+//the colors are split across the workers by their red component.
+auto LightTable::generate(uint luminance, uint saturation, uint gamma, WorkerPool& workers) -> void {
+  auto adjust = [=](double& dr, double& dg, double& db) {
+    if(saturation != 100) {
+      double satVal = saturation / 100.0;
+      double grayInv = (dr + dg + db) / 3 * max(0.0, 1.0 - satVal);
+      dr = dr * satVal + grayInv;
+      dg = dg * satVal + grayInv;
+      db = db * satVal + grayInv;
+    }
+
+    if(gamma != 100) {
+      double gamVal = gamma / 100.0;
+      double reciprocal = 1.0 / 127.0;
+      dr = dr > 127.0 ? dr : 127.0 * pow(dr * reciprocal, gamVal);
+      dg = dg > 127.0 ? dg : 127.0 * pow(dg * reciprocal, gamVal);
+      db = db > 127.0 ? db : 127.0 * pow(db * reciprocal, gamVal);
+    }
+
+    if(luminance != 100) {
+      double lumVal = luminance / 100.0;
+      dr *= lumVal;
+      dg *= lumVal;
+      db *= lumVal;
+    }
+  };
+
+  double channel[32];
+  if(saturation == 100) {
+    for(uint n : range(32)) {
+      double dr = n * 255.0 / 31.0, dg = dr, db = dr;
+      adjust(dr, dg, db);
+      channel[n] = dr;
+    }
+  }
+
+  auto data = this->data;
+  workers.run(32, 1, [&](uint begin, uint end) {
+    for(uint r = begin; r < end; r++) {
+      for(uint g : range(32)) {
+        for(uint b : range(32)) {
+          double dr, dg, db;
+          if(saturation == 100) {
+            dr = channel[r];
+            dg = channel[g];
+            db = channel[b];
+          } else {
+            dr = r * 255.0 / 31.0;
+            dg = g * 255.0 / 31.0;
+            db = b * 255.0 / 31.0;
+            adjust(dr, dg, db);
+          }
+
+          for(uint l : range(16)) {
+            double lVal = l / 15.0;
+            int ar = dr * lVal + 0.5;
+            int ag = dg * lVal + 0.5;
+            int ab = db * lVal + 0.5;
+            ar = max(0, min(255, ar));
+            ag = max(0, min(255, ag));
+            ab = max(0, min(255, ab));
+            data[l << 15 | r << 10 | g << 5 | b << 0] = ab << 16 | ag << 8 | ar << 0;
+          }
+        }
+      }
+    }
+  });
+
+  this->luminance = luminance;
+  this->saturation = saturation;
+  this->gamma = gamma;
+}
@@ -0,0 +1,24 @@
+//LightTable converts the 15-bit BGR colors of the S-PPU into 24-bit RGB output colors,
+//for each of the 16 display brightness levels, in one contiguous allocation.
+//
+//each PPU has its own table: the accurate PPU a plain linear ramp, built once,
+//and the fast PPU one with the luminance, saturation and gamma video settings applied.
+
+struct LightTable {
+  LightTable();
+  ~LightTable();
+
+  alwaysinline auto operator[](uint brightness) const -> const uint32* {
+    return data + (brightness << 15);
+  }
+
+  auto matches(uint luminance, uint saturation, uint gamma) const -> bool;
+  auto generate() -> void;
+  auto generate(uint luminance, uint saturation, uint gamma, WorkerPool& workers) -> void;
+
+private:
+  uint32* data = nullptr;
+  uint luminance = ~0;
+  uint saturation = ~0;
+  uint gamma = ~0;
+};
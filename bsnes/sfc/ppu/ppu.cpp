@@ -13,6 +13,7 @@ PPU ppu;
 #include "screen.cpp"
 #include "serialization.cpp"
 #include "counter/serialization.cpp"
+#include "light/light.cpp"
 
 PPU::PPU() :
 bg1(Background::ID::BG1),
@@ -22,19 +23,7 @@ bg4(Background::ID::BG4) {
   ppu1.version = 1;  //allowed values: 1
   ppu2.version = 3;  //allowed values: 1, 2, 3
 
-  for(uint l = 0; l < 16; l++) {
-    for(uint r = 0; r < 32; r++) {
-      for(uint g = 0; g < 32; g++) {
-        for(uint b = 0; b < 32; b++) {
-          double luma = (double)l * 8.0 / 15.0;
-          uint ar = (luma * r + 0.5);
-          uint ag = (luma * g + 0.5);
-          uint ab = (luma * b + 0.5);
-          lightTable[l][r << 10 | g << 5 | b << 0] = ab << 16 | ag << 8 | ar << 0;
-        }
-      }
-    }
-  }
+  lightTable.generate();
 }
 
 PPU::~PPU() {
@@ -91,6 +80,7 @@ auto PPU::power(bool reset) -> void {
   bus.map(reader, writer, "00-3f,80-bf:2100-213f");
 
   if(!reset) random.array((uint8*)vram.data, sizeof(vram.data));
+  vram.dirty.markAll();
 
   ppu1.mdr = random.bias(0xff);
   ppu2.mdr = random.bias(0xff);
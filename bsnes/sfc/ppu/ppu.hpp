@@ -54,10 +54,11 @@ private:
     auto& operator[](uint address) { return data[address & mask]; }
     uint16 data[64 * 1024];
     uint16 mask = 0x7fff;
+    DirtyPages dirty{64 * 1024 * sizeof(uint16)};
   } vram;
 
-  uint32 output[512 * 480];
-  uint32 lightTable[16][32768];
+  uint32 output[512 * 512];  //480 lines are output; without overscan, the blank scanlines after 224 are drawn past them
+  LightTable lightTable;
 
   struct {
     bool interlace;
@@ -6,6 +6,7 @@
 #include <emulator/emulator.hpp>
 #include <emulator/random.hpp>
 #include <emulator/cheat.hpp>
+#include <emulator/workers.hpp>
 
 #include <processor/arm7tdmi/arm7tdmi.hpp>
 #include <processor/gsu/gsu.hpp>
@@ -24,9 +25,12 @@ namespace SuperFamicom {
   namespace File = Emulator::File;
   using Random = Emulator::Random;
   using Cheat = Emulator::Cheat;
+  using WorkerPool = Emulator::WorkerPool;
   extern Random random;
   extern Cheat cheat;
 
+  #include <sfc/system/profiler.hpp>
+
   struct Scheduler {
     enum class Mode : uint { Run, Synchronize } mode;
     enum class Event : uint { Frame, Synchronized, Desynchronized } event;
@@ -37,17 +41,20 @@ namespace SuperFamicom {
 
     auto enter() -> void {
       host = co_active();
+      if(profiler.enabled) profiler.transfer(host, active);
       co_switch(active);
     }
 
     auto leave(Event event_) -> void {
       event = event_;
       active = co_active();
+      if(profiler.enabled) profiler.transfer(active, host);
       co_switch(host);
     }
 
     auto resume(cothread_t thread) -> void {
       if(mode == Mode::Synchronize) desynchronized = true;
+      if(profiler.enabled) profiler.transfer(co_active(), thread);
       co_switch(thread);
     }
 
@@ -127,9 +134,10 @@ namespace SuperFamicom {
     static inline auto PAL() -> bool;
   };
 
-  #include <sfc/system/system.hpp>
   #include <sfc/memory/memory.hpp>
+  #include <sfc/system/system.hpp>
   #include <sfc/ppu/counter/counter.hpp>
+  #include <sfc/ppu/light/light.hpp>
 
   #include <sfc/cpu/cpu.hpp>
   #include <sfc/smp/smp.hpp>
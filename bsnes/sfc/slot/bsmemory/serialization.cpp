@@ -2,7 +2,7 @@ auto BSMemory::serialize(serializer& s) -> void {
   Thread::serialize(s);
   if(ROM) return;
 
-  s.array(memory.data(), memory.size());
+  memory.dirty.serialize(s, memory.data(), memory.size());
 
   s.integer(pin.writable);
 
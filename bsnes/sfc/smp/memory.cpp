@@ -6,7 +6,10 @@ auto SMP::readRAM(uint16 address) -> uint8 {
 
 auto SMP::writeRAM(uint16 address, uint8 data) -> void {
   //writes to $ffc0-$ffff always go to apuram, even if the iplrom is enabled
-  if(io.ramWritable && !io.ramDisable) dsp.apuram[address] = data;
+  if(io.ramWritable && !io.ramDisable) {
+    dsp.apuram[address] = data;
+    dsp.apuramDirty.mark(address);
+  }
 }
 
 auto SMP::idle() -> void {
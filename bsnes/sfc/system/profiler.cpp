@@ -0,0 +1,195 @@
+auto Profiler::enable(bool enabled) -> void {
+  reset();
+  this->enabled = enabled;
+}
+
+auto Profiler::reset() -> void {
+  for(auto& component : components) component = {};
+  count = 0;
+  current = Components;
+  origin = last = chrono::nanosecond();
+  clockStart = 0;
+  frames.reset();
+  totals = {};
+}
+
+auto Profiler::transfer(cothread_t from, cothread_t to) -> void {
+  uint64_t now = chrono::nanosecond();
+  uint source = find(from);
+  uint target = find(to);
+
+  if(current == source && source < Components) {
+    auto& component = components[source];
+    component.time += now - last;
+    int64_t clocks = clock(source) - clockStart;
+    if(component.owner && clocks > 0) component.cycles += clocks / component.scale;
+  }
+  if(source < Components && target < Components) components[source].switches[target]++;
+
+  current = target;
+  last = now;
+  if(target < Components) clockStart = clock(target);
+}
+
+auto Profiler::frame() -> void {
+  uint64_t now = chrono::nanosecond();
+  if(current < Components) {
+    //the frame ends in the host thread, which is running now
+    components[current].time += now - last;
+    last = now;
+  }
+
+  Frame next;
+  next.begin = now - origin;
+  for(uint n : range(count)) {
+    auto& component = components[n];
+    next.time[n] = component.time;
+    next.cycles[n] = component.cycles;
+    for(uint m : range(count)) next.switches[n] += component.switches[m];
+  }
+
+  if(frames.size() < Frames) {
+    Frame sample;
+    sample.begin = totals.begin;
+    sample.end = next.begin;
+    for(uint n : range(count)) {
+      sample.time[n] = next.time[n] - totals.time[n];
+      sample.cycles[n] = next.cycles[n] - totals.cycles[n];
+      sample.switches[n] = next.switches[n] - totals.switches[n];
+    }
+    frames.append(sample);
+  }
+  totals = next;
+}
+
+//threads are named the first time they are seen; a thread that was never created is never seen
+auto Profiler::find(cothread_t thread) -> uint {
+  for(uint n : range(count)) {
+    if(components[n].thread == thread) return n;
+  }
+  resolve();
+  for(uint n : range(count)) {
+    if(components[n].thread == thread) return n;
+  }
+  return Components;
+}
+
+auto Profiler::resolve() -> void {
+  auto add = [&](cothread_t thread, Thread* owner, string name, int64_t scale) {
+    if(!thread || count >= Components) return;
+    for(uint n : range(count)) {
+      if(components[n].thread == thread) return;
+    }
+    auto& component = components[count++];
+    component.thread = thread;
+    component.owner = owner;
+    component.name = name;
+    component.frequency = owner ? owner->frequency : 0;
+    component.scale = scale;
+  };
+
+  //the CPU is the reference the other threads are synchronized against: it counts down the PPU clock, in master cycles.
+  //the other threads count their own cycles up, scaled by the CPU frequency; the PPU runs at the CPU frequency.
+  add(scheduler.host, nullptr, "host", 1);
+  add(cpu.thread, &cpu, "cpu", 1);
+  add(smp.thread, &smp, "smp", cpu.frequency);
+  add(ppu.thread, &ppu, "ppu", 1);
+
+  auto name = [](Thread* coprocessor) -> string {
+    if(coprocessor == &icd) return "icd";
+    if(coprocessor == &event) return "event";
+    if(coprocessor == &sa1) return "sa1";
+    if(coprocessor == &superfx) return "superfx";
+    if(coprocessor == &armdsp) return "armdsp";
+    if(coprocessor == &hitachidsp) return "hitachidsp";
+    if(coprocessor == &necdsp) return "necdsp";
+    if(coprocessor == &epsonrtc) return "epsonrtc";
+    if(coprocessor == &sharprtc) return "sharprtc";
+    if(coprocessor == &spc7110) return "spc7110";
+    if(coprocessor == &msu1) return "msu1";
+    if(coprocessor == &bsmemory) return "bsmemory";
+    return "coprocessor";
+  };
+  for(auto coprocessor : cpu.coprocessors) {
+    add(coprocessor->thread, coprocessor, name(coprocessor), cpu.frequency);
+  }
+}
+
+auto Profiler::clock(uint component) const -> int64_t {
+  auto owner = components[component].owner;
+  if(owner == &cpu) return -ppu.clock;
+  return owner ? owner->clock : 0;
+}
+
+auto Profiler::json() const -> string {
+  vector<string> entries;
+  for(uint n : range(count)) {
+    auto& component = components[n];
+    vector<string> switches;
+    for(uint m : range(count)) {
+      if(component.switches[m]) switches.append({"\"", components[m].name, "\": ", component.switches[m]});
+    }
+    entries.append({
+      "    {\"name\": \"", component.name, "\", \"frequency\": ", (uint64_t)component.frequency,
+      ", \"cycles\": ", component.cycles, ", \"time\": ", component.time,
+      ", \"switches\": {", switches.merge(", "), "}}"
+    });
+  }
+
+  vector<string> samples;
+  for(auto& frame : frames) {
+    auto list = [&](const uint64_t* values) -> string {
+      vector<string> items;
+      for(uint n : range(count)) items.append(values[n]);
+      return {"[", items.merge(", "), "]"};
+    };
+    samples.append({
+      "    {\"begin\": ", frame.begin, ", \"end\": ", frame.end, ", \"time\": ", list(frame.time),
+      ", \"cycles\": ", list(frame.cycles), ", \"switches\": ", list(frame.switches), "}"
+    });
+  }
+
+  return {
+    "{\n  \"frames\": ", frames.size(), ",\n",
+    "  \"components\": [\n", entries.merge(",\n"), "\n  ],\n",
+    "  \"perFrame\": [\n", samples.merge(",\n"), "\n  ]\n}\n"
+  };
+}
+
+//the Chrome trace event format (chrome://tracing, Perfetto): one track per thread.
+//the switches are far too frequent to record one by one, so each frame is drawn as one slice per thread,
+//laid end to end in the order of the threads, as long as the host time the thread had in that frame.
+auto Profiler::trace() const -> string {
+  auto microseconds = [](uint64_t nanoseconds) -> string {
+    return {nanoseconds / 1000, ".", pad(nanoseconds % 1000, 3, '0')};
+  };
+
+  vector<string> events;
+  for(uint n : range(count)) {
+    events.append({
+      "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": ", n,
+      ", \"args\": {\"name\": \"", components[n].name, "\"}}"
+    });
+  }
+  for(uint f : range(frames.size())) {
+    auto& frame = frames[f];
+    uint64_t begin = frame.begin;
+    for(uint n : range(count)) {
+      if(!frame.time[n]) continue;
+      events.append({
+        "  {\"name\": \"frame ", f, "\", \"ph\": \"X\", \"pid\": 1, \"tid\": ", n,
+        ", \"ts\": ", microseconds(begin), ", \"dur\": ", microseconds(frame.time[n]),
+        ", \"args\": {\"cycles\": ", frame.cycles[n], ", \"switches\": ", frame.switches[n], "}}"
+      });
+      begin += frame.time[n];
+    }
+    vector<string> switches;
+    for(uint n : range(count)) switches.append({"\"", components[n].name, "\": ", frame.switches[n]});
+    events.append({
+      "  {\"name\": \"switches\", \"ph\": \"C\", \"pid\": 1, \"ts\": ", microseconds(frame.begin),
+      ", \"args\": {", switches.merge(", "), "}}"
+    });
+  }
+
+  return {"{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n", events.merge(",\n"), "\n]}\n"};
+}
@@ -0,0 +1,62 @@
+//Profiler follows the cooperative threads through the scheduler, when enabled:
+//the switches between each pair of threads, the emulated cycles each thread ran,
+//and the host time spent in each thread, in total and for every frame.
+//
+//the host thread is the frontend, which runs between frames.
+//the DSP is not a thread of its own: it runs on the SMP thread, and is counted with it.
+
+struct Thread;
+
+struct Profiler {
+  enum : uint { Components = 16, Frames = 36000 };  //ten minutes of frames are kept
+
+  struct Component {
+    cothread_t thread = nullptr;
+    Thread* owner = nullptr;  //none for the host
+    string name;
+    double frequency = 0;
+    int64_t scale = 1;    //clock units per cycle
+    uint64_t time = 0;    //host time, in nanoseconds
+    uint64_t cycles = 0;  //emulated cycles, at its own frequency
+    uint64_t switches[Components] = {};  //to each other component
+  };
+
+  struct Frame {
+    uint64_t begin = 0;  //nanoseconds since profiling was enabled
+    uint64_t end = 0;
+    uint64_t time[Components] = {};
+    uint64_t cycles[Components] = {};
+    uint64_t switches[Components] = {};  //from each component
+  };
+
+  bool enabled = false;
+
+  auto enable(bool enabled) -> void;
+  auto reset() -> void;
+
+  //called by the scheduler before each co_switch
+  auto transfer(cothread_t from, cothread_t to) -> void;
+  //called at the end of each frame
+  auto frame() -> void;
+
+  auto json() const -> string;
+  auto trace() const -> string;
+
+private:
+  auto find(cothread_t thread) -> uint;
+  auto resolve() -> void;
+  auto clock(uint component) const -> int64_t;
+
+  Component components[Components];
+  uint count = 0;
+
+  uint current = Components;  //the running component, if known
+  uint64_t origin = 0;
+  uint64_t last = 0;
+  int64_t clockStart = 0;
+
+  vector<Frame> frames;
+  Frame totals;  //at the start of the current frame
+};
+
+extern Profiler profiler;
@@ -1,8 +1,27 @@
+//the state size is computed once when the system is powered on
+auto System::serializeSize(bool synchronize) const -> uint {
+  if(!co_serializable()) synchronize = true;
+  return information.serializeSize[synchronize];
+}
+
 auto System::serialize(bool synchronize) -> serializer {
   //deterministic serialization (synchronize=false) is only possible with select libco methods
   if(!co_serializable()) synchronize = true;
 
   if(!information.serializeSize[synchronize]) return {};  //should never occur
+  serializer s(information.serializeSize[synchronize]);
+  serialize(s, synchronize, false);
+  return s;
+}
+
+//saves into an existing buffer, which must be large enough to hold the entire state.
+//incremental saves only rewrite the memory pages that changed since the last incremental
+//save or load into the same buffer (see DirtyPages.)
+auto System::serialize(serializer& s, bool synchronize, bool incremental) -> bool {
+  if(!co_serializable()) synchronize = true;
+
+  if(!information.serializeSize[synchronize]) return false;
+  if(s.capacity() < information.serializeSize[synchronize]) return false;
   if(synchronize) runToSave();
 
   uint signature = 0x31545342;
@@ -11,18 +30,20 @@ auto System::serialize(bool synchronize) -> serializer {
   char description[512] = {};
   memory::copy(&version, (const char*)Emulator::SerializerVersion, Emulator::SerializerVersion.size());
 
-  serializer s(serializeSize);
+  s.setMode(serializer::Save);
   s.integer(signature);
   s.integer(serializeSize);
   s.array(version);
   s.array(description);
   s.boolean(synchronize);
   s.boolean(hacks.fastPPU);
+  DirtyPages::Incremental = incremental;
   serializeAll(s, synchronize);
-  return s;
+  DirtyPages::Incremental = false;
+  return true;
 }
 
-auto System::unserialize(serializer& s) -> bool {
+auto System::unserialize(serializer& s, bool incremental) -> bool {
   uint signature = 0;
   uint serializeSize = 0;
   char version[16] = {};
@@ -30,6 +51,9 @@ auto System::unserialize(serializer& s) -> bool {
   bool synchronize = false;
   bool fastPPU = false;
 
+  //the buffer may belong to the caller; do not read past its end
+  if(s.capacity() < min(information.serializeSize[0], information.serializeSize[1])) return false;
+
   s.integer(signature);
   s.integer(serializeSize);
   s.array(version);
@@ -39,14 +63,23 @@ auto System::unserialize(serializer& s) -> bool {
 
   if(signature != 0x31545342) return false;
   if(serializeSize != information.serializeSize[synchronize]) return false;
+  if(serializeSize > s.capacity()) return false;
   if(string{version} != Emulator::SerializerVersion) return false;
   if(fastPPU != hacks.fastPPU) return false;
 
   if(synchronize) power(/* reset = */ false);
+  DirtyPages::Incremental = incremental;
   serializeAll(s, synchronize);
+  DirtyPages::Incremental = false;
   return true;
 }
 
+//enables write tracking for incremental serialization.
+//the first save after enabling must be a full one, as writes made while disabled were not recorded.
+auto System::trackDirtyPages(bool enable) -> void {
+  DirtyPages::Enable = enable;
+}
+
 //internal
 
 auto System::serializeAll(serializer& s, bool synchronize) -> void {
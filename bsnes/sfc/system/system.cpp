@@ -6,7 +6,9 @@ System system;
 Scheduler scheduler;
 Random random;
 Cheat cheat;
+Profiler profiler;
 #include "serialization.cpp"
+#include "profiler.cpp"
 
 auto System::run() -> void {
   scheduler.mode = Scheduler::Mode::Run;
@@ -96,17 +98,34 @@ auto System::runToSaveStrict() -> void {
 
 auto System::frameEvent() -> void {
   ppu.refresh();
+  dsp.flush();
+  if(profiler.enabled) profiler.frame();
 
   //refresh all cheat codes once per frame
+  if(patchGeneration != bus.generation) compileCheats();
   Memory::GlobalWriteEnable = true;
-  for(auto& code : cheat.codes) {
-    if(code.enable) {
-      bus.write(code.address, code.data);
+  for(auto& patch : patches) {
+    if(auto& memory = patch.memory; memory.dirty) {
+      *memory.data = patch.data;
+      memory.dirty->mark(memory.target);
+    } else if(!memory.data || *memory.data != patch.data) {
+      bus.write(patch.address, patch.data);
     }
   }
   Memory::GlobalWriteEnable = false;
 }
 
+//resolves the enabled cheat codes against the bus map, so that most are written straight to memory.
+//codes in writable memory are written directly; codes in read-only memory only when the byte changed,
+//as it may be memory that tracks its writes itself; the others go through the bus.
+auto System::compileCheats() -> void {
+  patches.reset();
+  for(auto& code : cheat.codes) {
+    if(code.enable) patches.append({code.address, (uint8)code.data, bus.resolve(code.address)});
+  }
+  patchGeneration = bus.generation;
+}
+
 auto System::load(Emulator::Interface* interface) -> bool {
   information = {};
 
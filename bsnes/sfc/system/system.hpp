@@ -13,6 +13,7 @@ struct System {
   auto runToSaveFast() -> void;
   auto runToSaveStrict() -> void;
   auto frameEvent() -> void;
+  auto compileCheats() -> void;
 
   auto load(Emulator::Interface*) -> bool;
   auto save() -> void;
@@ -20,8 +21,11 @@ struct System {
   auto power(bool reset) -> void;
 
   //serialization.cpp
+  auto serializeSize(bool synchronize) const -> uint;
   auto serialize(bool synchronize) -> serializer;
-  auto unserialize(serializer&) -> bool;
+  auto serialize(serializer&, bool synchronize, bool incremental) -> bool;
+  auto unserialize(serializer&, bool incremental = false) -> bool;
+  auto trackDirtyPages(bool enable) -> void;
 
   uint frameSkip = 0;
   uint frameCounter = 0;
@@ -42,6 +46,15 @@ private:
     bool fastPPU = false;
   } hacks;
 
+  //the enabled cheat codes, as written every frame
+  struct Patch {
+    uint address;
+    uint8 data;
+    Bus::Direct memory;
+  };
+  vector<Patch> patches;
+  uint patchGeneration = ~0;  //the bus map the patches were resolved against
+
   auto serializeAll(serializer&, bool synchronize) -> void;
   auto serializeInit(bool synchronize) -> uint;
 
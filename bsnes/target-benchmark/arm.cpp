@@ -0,0 +1,158 @@
+//benchmark of the ARM7TDMI interpreter, as used by the ST018 (see ArmDSP): runs small built-in ARM programs
+//through the core with the ST018's memory map and one clock per access, without the rest of the system.
+//the final registers and RAM are hashed, so that runs of different builds can be checked against each other.
+
+#include <processor/arm7tdmi/arm7tdmi.hpp>
+
+struct ArmBenchmark : Processor::ARM7TDMI {
+  struct Workload {
+    const char* name;
+    vector<uint32_t> program;
+  };
+
+  //a table is filled with a hash, then scored by a subroutine called once per entry:
+  //shifted ALU operands, conditional execution, multiplies, loads, stores and LDM/STM
+  static auto search() -> Workload {
+    return {"search", {
+      0xe3a0d20e,  //      mov   sp, #0xe0000000
+      0xe28dda03,  //      add   sp, sp, #0x3000
+      0xe3a09000,  //      mov   r9, #0
+      0xe3a0020e,  //outer mov   r0, #0xe0000000
+      0xe3a01c01,  //      mov   r1, #256
+      0xe1a02009,  //      mov   r2, r9
+      0xe0822182,  //fill  add   r2, r2, r2, lsl #3
+      0xe02223a2,  //      eor   r2, r2, r2, lsr #7
+      0xe4802004,  //      str   r2, [r0], #4
+      0xe2511001,  //      subs  r1, r1, #1
+      0x1afffffa,  //      bne   fill
+      0xe3a0020e,  //      mov   r0, #0xe0000000
+      0xe3a010ff,  //      mov   r1, #255
+      0xe3a05000,  //      mov   r5, #0
+      0xeb000007,  //scan  bl    score
+      0xe0855003,  //      add   r5, r5, r3
+      0xe2511001,  //      subs  r1, r1, #1
+      0x1afffffb,  //      bne   scan
+      0xe3a0420a,  //      mov   r4, #0xa0000000
+      0xe7d46429,  //      ldrb  r6, [r4, r9, lsr #8]
+      0xe0899006,  //      add   r9, r9, r6
+      0xe2899001,  //      add   r9, r9, #1
+      0xeaffffeb,  //      b     outer
+      0xe92d4013,  //score stmfd sp!, {r0, r1, r4, lr}
+      0xe7903101,  //      ldr   r3, [r0, r1, lsl #2]
+      0xe5904004,  //      ldr   r4, [r0, #4]
+      0xe1530004,  //      cmp   r3, r4
+      0xc1a03004,  //      movgt r3, r4
+      0xe0040193,  //      mul   r4, r3, r1
+      0xe3140010,  //      tst   r4, #0x10
+      0x10833144,  //      addne r3, r3, r4, asr #2
+      0x004332e4,  //      subeq r3, r3, r4, ror #5
+      0xe20340ff,  //      and   r4, r3, #0xff
+      0xe1833804,  //      orr   r3, r3, r4, lsl #16
+      0xe8bd8013,  //      ldmfd sp!, {r0, r1, r4, pc}
+    }};
+  }
+
+  //a table of pseudo-random words is bubble sorted, over and over
+  static auto sort() -> Workload {
+    return {"sort", {
+      0xe3a0c20e,  //      mov   r12, #0xe0000000
+      0xe59fb050,  //      ldr   r11, =0x12345678
+      0xe1a0000c,  //again mov   r0, r12
+      0xe3a010c8,  //      mov   r1, #200
+      0xe02bb68b,  //init  eor   r11, r11, r11, lsl #13
+      0xe02bb8ab,  //      eor   r11, r11, r11, lsr #17
+      0xe02bb28b,  //      eor   r11, r11, r11, lsl #5
+      0xe480b004,  //      str   r11, [r0], #4
+      0xe2511001,  //      subs  r1, r1, #1
+      0x1afffff9,  //      bne   init
+      0xe3a020c7,  //      mov   r2, #199
+      0xe1a0000c,  //outer mov   r0, r12
+      0xe1a03002,  //      mov   r3, r2
+      0xe8900030,  //inner ldmia r0, {r4, r5}
+      0xe1540005,  //      cmp   r4, r5
+      0xc5805000,  //      strgt r5, [r0]
+      0xc5804004,  //      strgt r4, [r0, #4]
+      0xe2800004,  //      add   r0, r0, #4
+      0xe2533001,  //      subs  r3, r3, #1
+      0x1afffff8,  //      bne   inner
+      0xe2522001,  //      subs  r2, r2, #1
+      0x1afffff4,  //      bne   outer
+      0xeaffffea,  //      b     again
+      0x12345678,
+    }};
+  }
+
+  auto step(uint clocks) -> void override { clock += clocks; }
+  auto sleep() -> void override { step(1); }
+
+  //see ArmDSP::get() and ArmDSP::set(); the bridge registers read as zero
+  auto get(uint mode, uint32 address) -> uint32 override {
+    step(1);
+    auto memory = [&](const uint8_t* memory, uint32 address) -> uint32 {
+      if(mode & Word) return memory::readl<4>(memory + (address & ~3));
+      if(mode & Byte) return memory[address];
+      return 0;
+    };
+    switch(address & 0xe000'0000) {
+    case 0x0000'0000: return memory(programROM, address & 0x1ffff);
+    case 0xa000'0000: return memory(dataROM, address & 0x7fff);
+    case 0xe000'0000: return memory(programRAM, address & 0x3fff);
+    }
+    return 0;
+  }
+
+  auto set(uint mode, uint32 address, uint32 word) -> void override {
+    step(1);
+    if((address & 0xe000'0000) != 0xe000'0000) return;
+    address &= 0x3fff;
+    if(mode & Word) memory::writel<4>(programRAM + (address & ~3), word);
+    else if(mode & Byte) programRAM[address] = word;
+  }
+
+  //returns the nanoseconds taken to run the given number of instructions
+  auto run(const Workload& workload, uint instructions) -> uint64_t {
+    memory::fill<uint8_t>(programROM, sizeof(programROM));
+    memory::fill<uint8_t>(programRAM, sizeof(programRAM));
+    for(uint n : range(workload.program.size())) memory::writel<4>(programROM + n * 4, workload.program[n]);
+    for(uint n : range(sizeof(dataROM))) dataROM[n] = n * 37 >> 3;
+    clock = 0;
+    power();
+
+    auto start = chrono::nanosecond();
+    for(uint n : range(instructions)) {
+      processor.cpsr.t = 0;  //force ARM mode, as ArmDSP::main() does
+      instruction();
+    }
+    return chrono::nanosecond() - start;
+  }
+
+  //FNV-1a, over the registers and RAM
+  auto hash() -> uint64_t {
+    uint64_t value = 0xcbf2'9ce4'8422'2325;
+    auto hash = [&](uint8_t byte) { value = (value ^ byte) * 0x100'0000'01b3; };
+    auto& p = processor;  //the programs run in supervisor mode, which banks r13 and r14
+    for(uint32 word : {p.r0, p.r1, p.r2, p.r3, p.r4, p.r5, p.r6, p.r7, p.r8, p.r9, p.r10, p.r11, p.r12,
+                       p.svc.r13, p.svc.r14, p.r15}) {
+      for(uint b : range(4)) hash(word >> b * 8);
+    }
+    for(auto byte : programRAM) hash(byte);
+    return value;
+  }
+
+  uint8_t programROM[128 * 1024];
+  uint8_t dataROM[32 * 1024];
+  uint8_t programRAM[16 * 1024];
+  uint64_t clock = 0;
+};
+
+static auto armBenchmark(uint instructions, uint runs) -> void {
+  static ArmBenchmark core;
+  for(auto workload : {ArmBenchmark::search(), ArmBenchmark::sort()}) {
+    //the fastest of several runs, as the others are mostly disturbed by the host
+    uint64_t fastest = ~0ull;
+    for(uint run : range(runs)) fastest = min(fastest, core.run(workload, instructions));
+    uint64_t hundredths = fastest * 100 / instructions;  //of a nanosecond, per instruction
+    print(workload.name, ": ", instructions, " instructions, fastest of ", runs, ": ",
+      hundredths / 100, ".", pad(hundredths % 100, 2, '0'), " ns per instruction, ", core.clock, " clocks, state ", hex(core.hash(), 16L), "\n");
+  }
+}
@@ -0,0 +1,337 @@
+#include <emulator/emulator.hpp>
+#include <sfc/interface/interface.hpp>
+#include <nall/directory.hpp>
+#include <nall/main.hpp>
+#include <nall/decode/zip.hpp>
+using namespace nall;
+
+#include <heuristics/heuristics.hpp>
+#include <heuristics/heuristics.cpp>
+#include <heuristics/super-famicom.cpp>
+
+#include <target-libretro/resources.hpp>
+
+#include "arm.cpp"
+
+//headless benchmark of the Super Famicom core: runs a game for a number of frames as fast as possible,
+//without any video or audio output, and reports the throughput and the distribution of frame times.
+//optionally, an input movie (.bsv, as recorded by bsnes) is played back, and the output is hashed,
+//so that runs of different builds can be checked against each other.
+
+static Emulator::Interface* emulator = nullptr;
+
+struct Program : Emulator::Platform {
+  Program();
+
+  auto open(uint id, string name, vfs::file::mode mode, bool required) -> shared_pointer<vfs::file> override;
+  auto load(uint id, string name, string type, vector<string> options = {}) -> Emulator::Platform::Load override;
+  auto videoFrame(const uint32* data, uint pitch, uint width, uint height, uint scale) -> void override;
+  auto audioFrames(const double* samples, uint channels, uint frames) -> void override;
+  auto inputPoll(uint port, uint device, uint input) -> int16 override;
+
+  auto loadGame(string location) -> bool;
+  auto loadMovie(string location) -> bool;
+  auto run() -> void;
+
+  struct Game {
+    string location;
+    string title;
+    string region;
+    string manifest;
+    vector<uint8_t> program;
+    vector<uint8_t> data;
+    vector<uint8_t> expansion;
+  } game;
+
+  struct Movie {
+    vector<uint8_t> state;
+    vector<uint16_t> input;
+    uint offset = 0;
+  } movie;
+
+  struct RunAhead {
+    uint frames = 0;
+    serializer state;
+    bool valid = false;
+  } runAhead;
+
+  //FNV-1a, over the visible pixels of each frame and over the audio samples
+  struct Output {
+    static constexpr uint64_t Basis = 0xcbf2'9ce4'8422'2325;
+
+    auto hash(uint64_t& value, const void* data, uint size) -> void {
+      auto p = (const uint8_t*)data;
+      while(size--) value = (value ^ *p++) * 0x100'0000'01b3;
+    }
+
+    bool enabled = false;
+    uint64_t video = Basis;
+    uint64_t audio = Basis;
+    uint width = 0;
+    uint height = 0;
+    uint64_t time = 0;  //nanoseconds spent hashing, which is not counted as frame time
+  } output;
+};
+
+Program::Program() {
+  Emulator::platform = this;
+}
+
+auto Program::open(uint id, string name, vfs::file::mode mode, bool required) -> shared_pointer<vfs::file> {
+  if(mode != vfs::file::mode::read) return {};
+  if(name == "ipl.rom") return vfs::memory::file::open(iplrom, sizeof(iplrom));
+  if(name == "boards.bml") return vfs::memory::file::open(Boards, sizeof(Boards));
+  if(id != 1) return {};
+
+  if(name == "manifest.bml") return vfs::memory::file::open(game.manifest.data<uint8_t>(), game.manifest.size());
+  if(name == "program.rom") return vfs::memory::file::open(game.program.data(), game.program.size());
+  if(name == "data.rom") return vfs::memory::file::open(game.data.data(), game.data.size());
+  if(name == "expansion.rom") return vfs::memory::file::open(game.expansion.data(), game.expansion.size());
+  //save RAM is neither loaded nor stored, so that every run starts from the same state
+  return {};
+}
+
+auto Program::load(uint id, string name, string type, vector<string> options) -> Emulator::Platform::Load {
+  if(id == 1 && game.location) return {id, game.region};
+  return {};
+}
+
+auto Program::videoFrame(const uint32* data, uint pitch, uint width, uint height, uint scale) -> void {
+  output.width = width;
+  output.height = height;
+  if(!output.enabled) return;
+  auto start = chrono::nanosecond();
+  for(uint y : range(height)) {
+    output.hash(output.video, (const uint8_t*)data + y * pitch, width * sizeof(uint32));
+  }
+  output.time += chrono::nanosecond() - start;
+}
+
+auto Program::audioFrames(const double* samples, uint channels, uint frames) -> void {
+  if(!output.enabled) return;
+  auto start = chrono::nanosecond();
+  output.hash(output.audio, samples, frames * channels * sizeof(double));
+  output.time += chrono::nanosecond() - start;
+}
+
+auto Program::inputPoll(uint port, uint device, uint input) -> int16 {
+  //movies store every input that was polled, in order
+  if(movie.offset < movie.input.size()) return movie.input[movie.offset++];
+  return 0;
+}
+
+auto Program::loadGame(string location) -> bool {
+  vector<uint8_t> rom;
+  if(Location::suffix(location).downcase() == ".zip") {
+    Decode::ZIP archive;
+    if(archive.open(location)) {
+      for(auto& file : archive.file) {
+        auto type = Location::suffix(file.name).downcase();
+        if(type == ".sfc" || type == ".smc") {
+          rom = archive.extract(file);
+          break;
+        }
+      }
+    }
+  } else {
+    rom = file::read(location);
+  }
+  if(rom.size() < 0x8000) return false;
+
+  if((rom.size() & 0x7fff) == 512) {
+    //remove copier header
+    memory::move(&rom[0], &rom[512], rom.size() - 512);
+    rom.resize(rom.size() - 512);
+  }
+
+  auto heuristics = Heuristics::SuperFamicom(rom, location);
+  game.location = location;
+  game.title = heuristics.title();
+  game.region = heuristics.videoRegion();
+  game.manifest = heuristics.manifest();
+
+  uint offset = 0;
+  if(auto size = heuristics.programRomSize()) {
+    game.program.resize(size);
+    memory::copy(&game.program[0], &rom[offset], size);
+    offset += size;
+  }
+  if(auto size = heuristics.dataRomSize()) {
+    game.data.resize(size);
+    memory::copy(&game.data[0], &rom[offset], size);
+    offset += size;
+  }
+  if(auto size = heuristics.expansionRomSize()) {
+    game.expansion.resize(size);
+    memory::copy(&game.expansion[0], &rom[offset], size);
+    offset += size;
+  }
+  return true;
+}
+
+//see Program::moviePlay() of the bsnes target for the format
+auto Program::loadMovie(string location) -> bool {
+  auto fp = file::open(location, file::mode::read);
+  if(!fp) return false;
+  if(fp.read() != 'B' || fp.read() != 'S' || fp.read() != 'V' || fp.read() != '1') return false;
+  if(uint32_t size = fp.readl(4L)) {
+    if(fp.size() - fp.offset() < size) return false;
+    movie.state.resize(size);
+    fp.read({movie.state.data(), size});
+  }
+  while(fp.size() - fp.offset() >= 2) movie.input.append(fp.readl(2L));
+  return true;
+}
+
+//runs one frame; with run-ahead, the emulation is run ahead and rewound as the frontends do
+auto Program::run() -> void {
+  if(!runAhead.frames) return emulator->run();
+
+  emulator->setRunAhead(true);
+  emulator->run();
+  if(!runAhead.valid || !emulator->serialize(runAhead.state, false, true)) {
+    runAhead.state = emulator->serialize(0);
+    runAhead.valid = true;
+    emulator->trackDirtyPages(true);
+  }
+  //the frames run ahead are rewound, and so is the movie input they consumed
+  uint offset = movie.offset;
+  for(uint n : range(runAhead.frames - 1)) emulator->run();
+  emulator->setRunAhead(false);
+  emulator->run();
+  runAhead.state.setMode(serializer::Mode::Load);
+  if(!emulator->unserialize(runAhead.state, true)) {
+    runAhead.state = {};
+    runAhead.valid = false;
+  }
+  movie.offset = offset;
+}
+
+auto nall::main(Arguments arguments) -> void {
+  if(arguments.size() == 0 || arguments.find("--help")) {
+    print("usage: bsnes-benchmark [options] game.sfc\n");
+    print("       bsnes-benchmark --arm <instructions> [--runs <count>]\n\n");
+    print("  --frames <count>        frames to measure (default: 600)\n");
+    print("  --warmup <count>        frames to run before measuring (default: 0)\n");
+    print("  --movie <file.bsv>      play back an input movie\n");
+    print("  --hash                  hash the video and audio output\n");
+    print("  --fast-ppu <on|off>     scanline-based PPU (default: on)\n");
+    print("  --hd-scale <0-10>       HD mode 7 scale (default: 0)\n");
+    print("  --bg-grad <0-8>         HD fixed color gradient radius (default: 4)\n");
+    print("  --wind-rad <0-8>        HD window smoothing radius (default: 0)\n");
+    print("  --render-threads <n>    fast PPU render threads (default: automatic)\n");
+    print("  --fast-dsp <on|off>     fast DSP (default: on)\n");
+    print("  --run-ahead <0-4>       run-ahead frames (default: 0)\n");
+    print("  --delayed-sync <on|off> coprocessor delayed sync (default: on)\n");
+    print("  --profile <file.json>   write the scheduler profile of the measured frames\n");
+    print("  --trace <file.json>     write the scheduler profile as a Chrome trace\n");
+    print("  --arm <instructions>    benchmark the ARM7TDMI (ST018) interpreter instead of running a game\n");
+    print("  --runs <count>          ARM benchmark runs per program (default: 100)\n");
+    return;
+  }
+
+  auto option = [&](string_view name, string fallback) -> string {
+    string value;
+    return arguments.take(name, value) ? value : fallback;
+  };
+  auto enabled = [&](string_view name, bool fallback) -> bool {
+    auto value = option(name, fallback ? "on" : "off");
+    return value == "on" || value == "true" || value == "1";
+  };
+
+  uint frames = option("--frames", "600").natural();
+  uint warmup = option("--warmup", "0").natural();
+  string movie = option("--movie", "");
+  bool hash = arguments.take("--hash");
+  bool fastPPU = enabled("--fast-ppu", true);
+  uint scale = min(10u, (uint)option("--hd-scale", "0").natural());
+  uint bgGrad = min(8u, (uint)option("--bg-grad", "4").natural());
+  uint windRad = min(8u, (uint)option("--wind-rad", "0").natural());
+  string threads = option("--render-threads", "");
+  bool fastDSP = enabled("--fast-dsp", true);
+  uint runAhead = min(4u, (uint)option("--run-ahead", "0").natural());
+  bool delayedSync = enabled("--delayed-sync", true);
+  string profile = option("--profile", "");
+  string trace = option("--trace", "");
+  uint armInstructions = option("--arm", "0").natural();
+  uint armRuns = max(1u, (uint)option("--runs", "100").natural());
+  for(auto& argument : arguments) {
+    if(argument.beginsWith("--")) return print("unknown option: ", argument, "\n");
+  }
+  if(armInstructions) return armBenchmark(armInstructions, armRuns);
+  string location = arguments.take();
+  if(!location || frames == 0) return print("no game or frame count given\n");
+
+  Program program;
+  emulator = new SuperFamicom::Interface;
+  if(!program.loadGame(location)) return print("could not load ", location, "\n");
+  if(movie && !program.loadMovie(movie)) return print("could not load movie ", movie, "\n");
+
+  emulator->configure("Audio/Frequency", 48000.0);
+  emulator->configure("Hacks/Entropy", "None");  //runs must be repeatable
+  emulator->configure("Hacks/PPU/Fast", fastPPU);
+  emulator->configure("Hacks/PPU/Mode7/Scale", scale);
+  emulator->configure("Hacks/PPU/Mode7/BgGrad", bgGrad);
+  emulator->configure("Hacks/PPU/Mode7/WindRad", windRad);
+  if(threads) emulator->configure("Hacks/PPU/RenderThreads", threads.natural());
+  emulator->configure("Hacks/DSP/Fast", fastDSP);
+  emulator->configure("Hacks/Coprocessor/DelayedSync", delayedSync);
+  program.runAhead.frames = runAhead;
+
+  if(!emulator->load()) return print("could not load ", location, "\n");
+  emulator->connect(SuperFamicom::ID::Port::Controller1, SuperFamicom::ID::Device::Gamepad);
+  emulator->connect(SuperFamicom::ID::Port::Controller2, SuperFamicom::ID::Device::Gamepad);
+  emulator->power();
+  if(program.movie.state) {
+    serializer s{program.movie.state.data(), (uint)program.movie.state.size()};
+    if(!emulator->unserialize(s)) return print("could not load the state of movie ", movie, "\n");
+  }
+
+  for(uint frame : range(warmup)) program.run();
+  program.output.enabled = hash;
+  if(profile || trace) emulator->setProfiling(true);
+
+  vector<uint64_t> times;
+  uint64_t renderTime = 0;
+  uint64_t tileReads = emulator->tileCacheReads();
+  uint64_t tileDecodes = emulator->tileCacheDecodes();
+  auto start = chrono::nanosecond();
+  for(uint frame : range(frames)) {
+    auto frameStart = chrono::nanosecond();
+    auto hashTime = program.output.time;
+    program.run();
+    times.append(chrono::nanosecond() - frameStart - (program.output.time - hashTime));
+    renderTime += emulator->frameRenderTime();
+  }
+  uint64_t elapsed = chrono::nanosecond() - start - program.output.time;
+  if(profile) file::write(profile, emulator->profileJSON());
+  if(trace) file::write(trace, emulator->profileTrace());
+  emulator->setProfiling(false);
+
+  times.sort();
+  auto milliseconds = [](uint64_t nanoseconds) -> string {
+    return {nanoseconds / 1000000, ".", pad(nanoseconds / 1000 % 1000, 3, '0')};
+  };
+  uint64_t rate = frames * 10'000'000'000ull / max(1ull, elapsed);  //in tenths of frames per second
+  auto percentile = [&](uint percent) { return milliseconds(times[min(times.size() - 1, times.size() * percent / 100)]); };
+
+  print("game:       ", program.game.title, " (", program.game.region, ")\n");
+  print("frames:     ", frames, " in ", milliseconds(elapsed), " ms, ", rate / 10, ".", rate % 10, " fps\n");
+  print("frame time: min ", milliseconds(times.first()), " / p50 ", percentile(50), " / p90 ", percentile(90),
+    " / p99 ", percentile(99), " / max ", milliseconds(times.last()), " ms\n");
+  if(fastPPU) print("rendering:  ", milliseconds(renderTime / frames), " ms per frame\n");
+  if(fastPPU) {
+    tileReads = emulator->tileCacheReads() - tileReads;
+    tileDecodes = emulator->tileCacheDecodes() - tileDecodes;
+    uint hits = tileReads > tileDecodes ? (tileReads - tileDecodes) * 1000 / tileReads : 0;  //in tenths of a percent
+    print("tile cache: ", tileReads / frames, " rows read, ", tileDecodes / frames, " decoded per frame (",
+      hits / 10, ".", hits % 10, "% hits)\n");
+  }
+  if(hash) {
+    print("video:      ", hex(program.output.video, 16L), " (", program.output.width, "x", program.output.height, ")\n");
+    print("audio:      ", hex(program.output.audio, 16L), "\n");
+  }
+
+  emulator->unload();
+  delete emulator;
+}
@@ -19,6 +19,11 @@ extern unique_pointer<Emulator::Interface> emulator;
 #include <nall/encode/rle.hpp>
 #include <nall/encode/zip.hpp>
 #include <nall/hash/crc16.hpp>
+#include <nall/hash/crc32.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 #include "program/program.hpp"
 #include "input/input.hpp"
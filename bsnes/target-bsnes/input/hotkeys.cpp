@@ -46,6 +46,7 @@ auto InputManager::bindHotkeys() -> void {
   }).onRelease([&] {
     program.rewinding = false;
     if(!emulator->loaded()) return;
+    if(program.rewind.frequency) program.showMessage(program.rewindStatus());
     program.rewindMode(Program::Rewind::Mode::Playing);
     program.mute &= ~Program::Mute::Rewind;
     Emulator::audio.setVolume(volume);
@@ -0,0 +1,104 @@
+//the game and cheat databases are large BML documents, of which a game only ever needs one node.
+//on first use, each is compiled into a binary index that is memory-mapped for every lookup afterward:
+//a header, the SHA-256 hashes of the nodes in sorted order, and the nodes themselves, serialized.
+//the index records the size and time of the database it was compiled from, and is compiled again when they change.
+
+namespace {
+  enum : uint { DatabaseSignature = 0x31494442 };  //"BDI1"
+  enum : uint { DatabaseHeaderSize = 32, DatabaseEntrySize = 40 };
+
+  //the 32-byte binary form of a hexadecimal SHA-256 digest
+  auto databaseKey(string sha256) -> vector<uint8_t> {
+    vector<uint8_t> key;
+    if(sha256.size() != 64) return key;
+    for(uint n : range(32)) key.append(string{sha256.slice(n * 2, 2)}.hex());
+    return key;
+  }
+
+  //binary searches an index held in memory: mapped from disk, or just compiled
+  auto databaseSearch(const uint8_t* data, uint64_t size, const vector<uint8_t>& key) -> string {
+    uint count = memory::readl<4>(data + 4);
+    uint lo = 0, hi = count;
+    while(lo < hi) {
+      uint mid = lo + (hi - lo) / 2;
+      auto entry = data + DatabaseHeaderSize + mid * DatabaseEntrySize;
+      int order = memory::compare(entry, key.data(), 32);
+      if(order < 0) { lo = mid + 1; continue; }
+      if(order > 0) { hi = mid; continue; }
+      uint offset = memory::readl<4>(entry + 32);
+      uint length = memory::readl<4>(entry + 36);
+      if((uint64_t)offset + length > size) return {};
+      return string_view{(const char*)data + offset, length};
+    }
+    return {};
+  }
+}
+
+//returns the serialized database node of the game with the given SHA-256, or nothing if it is not in the database
+auto Program::databaseFind(string name, string node, string sha256) -> string {
+  auto key = databaseKey(sha256);
+  string source = locate({"Database/", name, ".bml"});
+  if(!key || !file::exists(source)) return {};
+  uint64_t size = file::size(source);
+  uint64_t time = file::timestamp(source, file::time::modify);
+
+  string location = locate({"Database/", name, ".bdi"});
+  file_map map;
+  if(map.open(location, file_map::mode::read) && map.size() >= DatabaseHeaderSize) {
+    auto data = map.data();
+    uint count = memory::readl<4>(data + 4);
+    if(memory::readl<4>(data + 0) == DatabaseSignature
+    && memory::readl<8>(data + 8) == size
+    && memory::readl<8>(data + 16) == time
+    && DatabaseHeaderSize + (uint64_t)count * DatabaseEntrySize <= map.size()
+    ) return databaseSearch(data, map.size(), key);
+  }
+  map.close();
+
+  //the index is missing or stale: compile it, and search it without waiting for it to be read back
+  auto index = databaseIndex(BML::unserialize(string::read(source)), node, size, time);
+  directory::create(Location::path(location));
+  file::write(location, index);
+  return databaseSearch(index.data(), index.size(), key);
+}
+
+auto Program::databaseIndex(const Markup::Node& document, string node, uint64_t size, uint64_t time) -> vector<uint8_t> {
+  struct Entry {
+    vector<uint8_t> key;
+    string text;
+    uint order;
+  };
+  vector<Entry> entries;
+  for(auto item : document.find(node)) {
+    auto key = databaseKey(item["sha256"].text());
+    if(key) entries.append({key, BML::serialize(item), entries.size()});
+  }
+  //a hash listed more than once resolves to its first node, as a search of the database would
+  entries.sort([](const Entry& x, const Entry& y) {
+    int order = memory::compare(x.key.data(), y.key.data(), 32);
+    return order ? order < 0 : x.order < y.order;
+  });
+  vector<Entry> unique;
+  for(auto& entry : entries) {
+    if(unique && memory::compare(unique.last().key.data(), entry.key.data(), 32) == 0) continue;
+    unique.append(entry);
+  }
+
+  vector<uint8_t> output;
+  output.resize(DatabaseHeaderSize + unique.size() * DatabaseEntrySize);
+  memory::writel<4>(output.data() + 0, DatabaseSignature);
+  memory::writel<4>(output.data() + 4, unique.size());
+  memory::writel<8>(output.data() + 8, size);
+  memory::writel<8>(output.data() + 16, time);
+  for(uint n : range(unique.size())) {
+    auto& text = unique[n].text;
+    uint offset = output.size();
+    output.resize(offset + text.size());
+    memory::copy(output.data() + offset, text.data(), text.size());
+    auto entry = output.data() + DatabaseHeaderSize + n * DatabaseEntrySize;
+    memory::copy(entry, unique[n].key.data(), 32);
+    memory::writel<4>(entry + 32, offset);
+    memory::writel<4>(entry + 36, text.size());
+  }
+  return output;
+}
@@ -10,6 +10,9 @@ auto Program::load() -> void {
   emulator->configure("Hacks/PPU/Deinterlace", settings.emulator.hack.ppu.deinterlace);
   emulator->configure("Hacks/PPU/NoSpriteLimit", settings.emulator.hack.ppu.noSpriteLimit);
   emulator->configure("Hacks/PPU/NoVRAMBlocking", settings.emulator.hack.ppu.noVRAMBlocking);
+  emulator->configure("Hacks/PPU/RenderThreads", settings.emulator.hack.ppu.renderThreads);
+  emulator->configure("Hacks/PPU/RenderPipeline", settings.emulator.hack.ppu.renderPipeline);
+  emulator->configure("Hacks/PPU/RenderIncremental", settings.emulator.hack.ppu.renderIncremental);
   emulator->configure("Hacks/PPU/Mode7/Scale", settings.emulator.hack.ppu.mode7.scale);
   emulator->configure("Hacks/PPU/Mode7/Perspective", settings.emulator.hack.ppu.mode7.perspective);
   emulator->configure("Hacks/PPU/Mode7/Supersample", settings.emulator.hack.ppu.mode7.supersample);
@@ -144,13 +147,11 @@ auto Program::loadSuperFamicom(string location) -> bool {
   auto sha256 = Hash::SHA256(rom).digest();
   superFamicom.title = heuristics.title();
   superFamicom.region = heuristics.videoRegion();
-  if(auto document = BML::unserialize(string::read(locate("Database/Super Famicom.bml")))) {
-    if(auto game = document[{"game(sha256=", sha256, ")"}]) {
-      manifest = BML::serialize(game);
-      //the internal ROM header title is not present in the database, but is needed for internal core overrides
-      manifest.append("  title: ", superFamicom.title, "\n");
-      superFamicom.verified = true;
-    }
+  if(auto game = databaseFind("Super Famicom", "game", sha256)) {
+    manifest = game;
+    //the internal ROM header title is not present in the database, but is needed for internal core overrides
+    manifest.append("  title: ", superFamicom.title, "\n");
+    superFamicom.verified = true;
   }
   superFamicom.manifest = manifest ? manifest : heuristics.manifest();
   hackPatchMemory(rom);
@@ -217,17 +218,13 @@ auto Program::loadGameBoy(string location) -> bool {
   gameBoy.patched = applyPatchIPS(rom, location, "") || applyPatchBPS(rom, location, "");
   auto heuristics = Heuristics::GameBoy(rom, location);
   auto sha256 = Hash::SHA256(rom).digest();
-  if(auto document = BML::unserialize(string::read(locate("Database/Game Boy.bml")))) {
-    if(auto game = document[{"game(sha256=", sha256, ")"}]) {
-      manifest = BML::serialize(game);
-      gameBoy.verified = true;
-    }
+  if(auto game = databaseFind("Game Boy", "game", sha256)) {
+    manifest = game;
+    gameBoy.verified = true;
   }
-  if(auto document = BML::unserialize(string::read(locate("Database/Game Boy Color.bml")))) {
-    if(auto game = document[{"game(sha256=", sha256, ")"}]) {
-      manifest = BML::serialize(game);
-      gameBoy.verified = true;
-    }
+  if(auto game = databaseFind("Game Boy Color", "game", sha256)) {
+    manifest = game;
+    gameBoy.verified = true;
   }
   gameBoy.manifest = manifest ? manifest : heuristics.manifest();
   gameBoy.document = BML::unserialize(gameBoy.manifest);
@@ -254,11 +251,9 @@ auto Program::loadBSMemory(string location) -> bool {
   bsMemory.patched = applyPatchIPS(rom, location, "") || applyPatchBPS(rom, location, "");
   auto heuristics = Heuristics::BSMemory(rom, location);
   auto sha256 = Hash::SHA256(rom).digest();
-  if(auto document = BML::unserialize(string::read(locate("Database/BS Memory.bml")))) {
-    if(auto game = document[{"game(sha256=", sha256, ")"}]) {
-      manifest = BML::serialize(game);
-      bsMemory.verified = true;
-    }
+  if(auto game = databaseFind("BS Memory", "game", sha256)) {
+    manifest = game;
+    bsMemory.verified = true;
   }
   bsMemory.manifest = manifest ? manifest : heuristics.manifest();
   bsMemory.document = BML::unserialize(bsMemory.manifest);
@@ -284,11 +279,9 @@ auto Program::loadSufamiTurboA(string location) -> bool {
   sufamiTurboA.patched = applyPatchIPS(rom, location, "") || applyPatchBPS(rom, location, "");
   auto heuristics = Heuristics::SufamiTurbo(rom, location);
   auto sha256 = Hash::SHA256(rom).digest();
-  if(auto document = BML::unserialize(string::read(locate("Database/Sufami Turbo.bml")))) {
-    if(auto game = document[{"game(sha256=", sha256, ")"}]) {
-      manifest = BML::serialize(game);
-      sufamiTurboA.verified = true;
-    }
+  if(auto game = databaseFind("Sufami Turbo", "game", sha256)) {
+    manifest = game;
+    sufamiTurboA.verified = true;
   }
   sufamiTurboA.manifest = manifest ? manifest : heuristics.manifest();
   sufamiTurboA.document = BML::unserialize(sufamiTurboA.manifest);
@@ -314,11 +307,9 @@ auto Program::loadSufamiTurboB(string location) -> bool {
   sufamiTurboB.patched = applyPatchIPS(rom, location, "") || applyPatchBPS(rom, location, "");
   auto heuristics = Heuristics::SufamiTurbo(rom, location);
   auto sha256 = Hash::SHA256(rom).digest();
-  if(auto document = BML::unserialize(string::read(locate("Database/Sufami Turbo.bml")))) {
-    if(auto game = document[{"game(sha256=", sha256, ")"}]) {
-      manifest = BML::serialize(game);
-      sufamiTurboB.verified = true;
-    }
+  if(auto game = databaseFind("Sufami Turbo", "game", sha256)) {
+    manifest = game;
+    sufamiTurboB.verified = true;
   }
   sufamiTurboB.manifest = manifest ? manifest : heuristics.manifest();
   sufamiTurboB.document = BML::unserialize(sufamiTurboB.manifest);
@@ -350,14 +341,17 @@ auto Program::unload() -> void {
     video.output();
   }
   audio.clear();
-  rewindReset();  //free up memory that is no longer needed
+  rewindReset();
+  rewind.buffer.reset();  //free up memory that is no longer needed
   movieStop();  //in case a movie is currently being played or recorded
   cheatEditor.saveCheats();
   toolsWindow.setVisible(false);
   if(emulatorSettings.autoSaveStateOnUnload.checked()) {
     saveUndoState();
   }
+  stateStore.close();  //waits for the states still being written
   emulator->unload();
+  runAheadReset();
   showMessage("Game unloaded");
   superFamicom = {};
   gameBoy = {};
@@ -4,6 +4,8 @@
 #include "game-pak.cpp"
 #include "game-rom.cpp"
 #include "paths.cpp"
+#include "database.cpp"
+#include "state-store.cpp"
 #include "states.cpp"
 #include "movies.cpp"
 #include "rewind.cpp"
@@ -75,6 +77,7 @@ auto Program::create() -> void {
 
 auto Program::main() -> void {
   updateStatus();
+  if(auto failure = stateStore.failure()) showMessage(failure);
   video.poll();
 
   if(Application::modal()) {
@@ -99,14 +102,13 @@ auto Program::main() -> void {
   } else {
     emulator->setRunAhead(true);
     emulator->run();
-    auto state = emulator->serialize(0);
+    runAheadSave();
     if(settings.emulator.runAhead.frames >= 2) emulator->run();
     if(settings.emulator.runAhead.frames >= 3) emulator->run();
     if(settings.emulator.runAhead.frames >= 4) emulator->run();
     emulator->setRunAhead(false);
     emulator->run();
-    state.setMode(serializer::Mode::Load);
-    emulator->unserialize(state);
+    runAheadLoad();
   }
 
   if(emulatorSettings.autoSaveMemory.checked()) {
@@ -142,3 +144,21 @@ auto Program::quit() -> void {
 
   Application::exit();
 }
+
+auto Program::runAheadSave() -> void {
+  if(runAhead.valid && emulator->serialize(runAhead.state, false, true)) return;
+  runAhead.state = emulator->serialize(0);
+  runAhead.valid = true;
+  emulator->trackDirtyPages(true);
+}
+
+auto Program::runAheadLoad() -> void {
+  runAhead.state.setMode(serializer::Mode::Load);
+  if(!emulator->unserialize(runAhead.state, true)) runAheadReset();
+}
+
+auto Program::runAheadReset() -> void {
+  runAhead.state = {};
+  runAhead.valid = false;
+  emulator->trackDirtyPages(false);
+}
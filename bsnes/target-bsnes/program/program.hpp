@@ -1,3 +1,5 @@
+#include "state-store.hpp"
+
 struct Program : Lock, Emulator::Platform {
   Application::Namespace tr{"Program"};
 
@@ -6,6 +8,16 @@ struct Program : Lock, Emulator::Platform {
   auto main() -> void;
   auto quit() -> void;
 
+  //run-ahead keeps one state buffer alive; after the first full snapshot,
+  //only memory pages written since the last save or load are transferred
+  struct RunAhead {
+    serializer state;
+    bool valid = false;
+  } runAhead;
+  auto runAheadSave() -> void;
+  auto runAheadLoad() -> void;
+  auto runAheadReset() -> void;
+
   //platform.cpp
   auto open(uint id, string name, vfs::file::mode mode, bool required) -> shared_pointer<vfs::file> override;
   auto load(uint id, string name, string type, vector<string> options = {}) -> Emulator::Platform::Load override;
@@ -50,6 +62,10 @@ struct Program : Lock, Emulator::Platform {
   auto statePath() -> string;
   auto screenshotPath() -> string;
 
+  //database.cpp
+  auto databaseFind(string name, string node, string sha256) -> string;
+  auto databaseIndex(const Markup::Node& document, string node, uint64_t size, uint64_t time) -> vector<uint8_t>;
+
   //states.cpp
   struct State {
     string name;
@@ -66,6 +82,8 @@ struct Program : Lock, Emulator::Platform {
   auto removeState(string filename) -> bool;
   auto renameState(string from, string to) -> bool;
 
+  StateStore stateStore;
+
   //movies.cpp
   struct Movie {
     enum Mode : uint { Inactive, Playing, Recording } mode = Mode::Inactive;
@@ -80,14 +98,37 @@ struct Program : Lock, Emulator::Platform {
   //rewind.cpp
   struct Rewind {
     enum Mode : uint { Playing, Rewinding } mode = Mode::Playing;
-    vector<serializer> history;
+    //the most recent snapshot is kept in full (keyframe);
+    //older snapshots are stored as XOR/RLE deltas against their successor in a preallocated ring
+    struct Delta {
+      uint offset = 0;
+      uint size = 0;
+    };
+    vector<uint8_t> keyframe;
+    vector<uint8_t> buffer;  //delta ring storage
+    vector<Delta> deltas;    //delta ring index
+    uint first = 0;          //index of the oldest delta
+    uint count = 0;          //number of deltas in the ring
+    uint head = 0;           //next write offset into buffer
     uint length = 0;
     uint frequency = 0;
     uint counter = 0;  //in frames
+
+    struct Statistics {
+      uint64_t snapshots = 0;
+      uint64_t unpacked = 0;  //bytes
+      uint64_t packed = 0;    //bytes
+      uint64_t time = 0;      //microseconds
+    } statistics;
   } rewind;
   auto rewindMode(Rewind::Mode) -> void;
   auto rewindReset() -> void;
   auto rewindRun() -> void;
+  auto rewindSize() const -> uint;
+  auto rewindStatus() const -> string;
+  auto rewindEncode(const uint8_t* data, uint size) -> bool;
+  auto rewindDecode() -> void;
+  auto rewindEvict() -> void;
 
   //video.cpp
   auto updateVideoDriver(Window parent) -> void;
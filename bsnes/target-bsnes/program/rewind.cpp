@@ -5,22 +5,31 @@ auto Program::rewindMode(Rewind::Mode mode) -> void {
 
 auto Program::rewindReset() -> void {
   rewindMode(Rewind::Mode::Playing);
-  rewind.history.reset();
+  rewind.keyframe.reset();
+  rewind.first = 0;
+  rewind.count = 0;
+  rewind.head = 0;
+  rewind.statistics = {};
   rewind.frequency = settings.rewind.frequency;
-  rewind.length = settings.rewind.length;
+  rewind.length = max(1u, settings.rewind.length);
+  rewind.deltas.reset();
+  rewind.deltas.resize(rewind.length);
+  //the delta ring is kept allocated across resets; it is only resized when the memory budget changes
+  if(rewind.frequency == 0) rewind.buffer.reset();
 }
 
 auto Program::rewindRun() -> void {
   if(rewind.frequency == 0) return;  //rewind disabled?
 
   if(rewind.mode == Rewind::Mode::Rewinding) {
-    if(rewind.history.size() == 0) return rewindMode(Rewind::Mode::Playing);  //nothing left to rewind?
+    if(!rewind.keyframe) return rewindMode(Rewind::Mode::Playing);  //nothing left to rewind?
     if(++rewind.counter < rewind.frequency / 4) return;
 
     rewind.counter = 0;
-    auto t = rewind.history.takeLast();
-    serializer s{t.data(), t.size()};  //convert serializer::Save to serializer::Load
-    if(!rewind.history) {
+    serializer s{rewind.keyframe.data(), (uint)rewind.keyframe.size()};
+    if(rewind.count) {
+      rewindDecode();  //the keyframe now holds the previous snapshot
+    } else {
       showMessage("Rewind history exhausted");
       rewindReset();
     }
@@ -32,11 +41,139 @@ auto Program::rewindRun() -> void {
     if(++rewind.counter < rewind.frequency) return;
 
     rewind.counter = 0;
-    if(rewind.history.size() >= rewind.length) {
-      rewind.history.takeFirst();
-    }
+    auto start = chrono::microsecond();
     auto s = emulator->serialize(0);
-    rewind.history.append(s);
+    if(rewind.keyframe.size() != s.size()) {
+      //first snapshot, or the state size changed: restart the history from a new keyframe
+      rewind.first = 0;
+      rewind.count = 0;
+      rewind.head = 0;
+      rewind.keyframe.resize(s.size());
+      memory::copy(rewind.keyframe.data(), s.data(), s.size());
+    } else if(!rewindEncode(s.data(), s.size())) {
+      //the memory budget cannot hold even a single delta
+      memory::copy(rewind.keyframe.data(), s.data(), s.size());
+      rewind.first = 0;
+      rewind.count = 0;
+    }
+    rewind.statistics.snapshots++;
+    rewind.statistics.unpacked += s.size();
+    rewind.statistics.time += chrono::microsecond() - start;
     return;
   }
 }
+
+//total memory used by the rewind history, in bytes
+auto Program::rewindSize() const -> uint {
+  uint size = rewind.keyframe.size();
+  for(uint n : range(rewind.count)) {
+    size += rewind.deltas[(rewind.first + n) % rewind.length].size;
+  }
+  return size;
+}
+
+auto Program::rewindStatus() const -> string {
+  uint states = rewind.keyframe ? 1 + rewind.count : 0;
+  auto& stats = rewind.statistics;
+  uint ratio = stats.packed ? stats.unpacked * 10 / stats.packed : 0;
+  uint cost = stats.snapshots ? stats.time / stats.snapshots : 0;
+  return {
+    "Rewind: ", states, " states, ", (rewindSize() + 1023) / 1024, " KiB, ",
+    ratio / 10, ".", ratio % 10, ":1 compression, ", cost, " us per snapshot"
+  };
+}
+
+//stores the keyframe as a delta against the new snapshot, and then makes the new snapshot the keyframe.
+//delta format: a sequence of (skip, length) varint pairs, each followed by length bytes of XOR data.
+auto Program::rewindEncode(const uint8_t* data, uint size) -> bool {
+  uint capacity = settings.rewind.memory * 1024 * 1024;
+  if(rewind.buffer.size() != capacity) {
+    rewind.buffer.reset();
+    rewind.buffer.resize(capacity);
+    rewind.first = 0;
+    rewind.count = 0;
+    rewind.head = 0;
+  }
+
+  //runs only end on eight or more unchanged bytes, which bounds the worst-case encoded size
+  uint bound = size + size / 4 + 16;
+  if(bound > capacity) return false;
+
+  while(rewind.count && rewind.count + 2 > rewind.length) rewindEvict();
+  if(rewind.head + bound > capacity) {
+    //wrap around: the deltas between head and the end of the ring are the oldest ones
+    while(rewind.count && rewind.deltas[rewind.first].offset >= rewind.head) rewindEvict();
+    rewind.head = 0;
+  }
+  while(rewind.count) {
+    auto& oldest = rewind.deltas[rewind.first];
+    if(oldest.offset >= rewind.head + bound || oldest.offset + oldest.size <= rewind.head) break;
+    rewindEvict();
+  }
+
+  auto key = rewind.keyframe.data();
+  auto output = rewind.buffer.data() + rewind.head;
+  uint offset = 0;
+  auto write = [&](uint value) {
+    while(value >= 0x80) output[offset++] = value | 0x80, value >>= 7;
+    output[offset++] = value;
+  };
+
+  uint index = 0;
+  while(index < size) {
+    uint start = index;
+    while(index + 8 <= size && !memory::compare(key + index, data + index, 8)) index += 8;
+    while(index < size && key[index] == data[index]) index++;
+    if(index == size) break;
+
+    uint end = index, same = 0;
+    while(end < size && same < 8) same = key[end] == data[end] ? same + 1 : 0, end++;
+    uint length = end - index - same;
+
+    write(index - start);
+    write(length);
+    for(uint n : range(length)) {
+      output[offset++] = key[index] ^ data[index];
+      key[index] = data[index];
+      index++;
+    }
+  }
+
+  rewind.deltas[(rewind.first + rewind.count) % rewind.length] = {rewind.head, offset};
+  rewind.count++;
+  rewind.head += offset;
+  rewind.statistics.packed += offset;
+  return true;
+}
+
+//applies the newest delta to the keyframe, turning it into the previous snapshot
+auto Program::rewindDecode() -> void {
+  if(!rewind.count) return;
+  auto& delta = rewind.deltas[(rewind.first + --rewind.count) % rewind.length];
+  auto key = rewind.keyframe.data();
+  auto input = rewind.buffer.data() + delta.offset;
+  uint offset = 0;
+  auto read = [&]() -> uint {
+    uint value = 0;
+    for(uint shift = 0;; shift += 7) {
+      uint8_t byte = input[offset++];
+      value |= (byte & 0x7f) << shift;
+      if(!(byte & 0x80)) return value;
+    }
+  };
+
+  uint index = 0;
+  while(offset < delta.size) {
+    index += read();
+    uint length = read();
+    while(length--) key[index++] ^= input[offset++];
+  }
+  rewind.head = delta.offset;
+}
+
+//drops the oldest delta from the ring
+auto Program::rewindEvict() -> void {
+  if(!rewind.count) return;
+  rewind.first = (rewind.first + 1) % rewind.length;
+  rewind.count--;
+}
@@ -0,0 +1,527 @@
+namespace {
+  //the archive is written from the background writer thread, so this must not share localtime()'s buffer with the UI
+  auto localTime(time_t timestamp) -> tm {
+    tm info = {};
+    #if defined(PLATFORM_WINDOWS)
+    localtime_s(&info, &timestamp);
+    #else
+    localtime_r(&timestamp, &info);
+    #endif
+    return info;
+  }
+
+  //ZIP stores local times in MS-DOS format
+  auto dosTime(time_t timestamp) -> uint16_t {
+    tm info = localTime(timestamp);
+    return info.tm_hour << 11 | info.tm_min << 5 | info.tm_sec >> 1;
+  }
+
+  auto dosDate(time_t timestamp) -> uint16_t {
+    tm info = localTime(timestamp);
+    return (info.tm_year - 80) << 9 | (1 + info.tm_mon) << 5 | info.tm_mday;
+  }
+
+  auto unixTime(uint16_t time, uint16_t date) -> uint64_t {
+    tm info = {};
+    info.tm_sec  = (time >>  0 &  31) << 1;
+    info.tm_min  = (time >>  5 &  63);
+    info.tm_hour = (time >> 11 &  31);
+    info.tm_mday = (date >>  0 &  31);
+    info.tm_mon  = (date >>  5 &  15) - 1;
+    info.tm_year = (date >>  9 & 127) + 80;
+    info.tm_isdst = -1;
+    return mktime(&info);
+  }
+
+  auto readl(const uint8_t* data, uint size) -> uint32_t {
+    uint32_t result = 0;
+    for(uint n : range(size)) result |= data[n] << n * 8;
+    return result;
+  }
+
+  auto writel(vector<uint8_t>& output, uint32_t value, uint size) -> void {
+    for(uint n : range(size)) output.append(value >> n * 8);
+  }
+
+  auto writes(vector<uint8_t>& output, const string& text) -> void {
+    for(auto byte : text) output.append(byte);
+  }
+
+  auto writeHeader(vector<uint8_t>& output, const string& filename, uint64_t date, uint32_t checksum, uint32_t size) -> void {
+    writel(output, 0x04034b50, 4);       //signature
+    writel(output, 0x0014, 2);           //minimum version (2.0)
+    writel(output, 0x0000, 2);           //general purpose bit flags
+    writel(output, 0x0000, 2);           //compression method (0 = uncompressed)
+    writel(output, dosTime(date), 2);
+    writel(output, dosDate(date), 2);
+    writel(output, checksum, 4);
+    writel(output, size, 4);             //compressed size
+    writel(output, size, 4);             //uncompressed size
+    writel(output, filename.size(), 2);  //file name length
+    writel(output, 0x0000, 2);           //extra field length
+    writes(output, filename);
+  }
+
+  //writes the data at the offset, cutting the file after it, and waits for the file to reach the disk
+  auto commit(const string& filename, uint64_t offset, const vector<uint8_t>& data) -> bool {
+    #if defined(API_POSIX)
+    FILE* fp = fopen(filename, file::exists(filename) ? "rb+" : "wb");
+    #elif defined(API_WINDOWS)
+    FILE* fp = _wfopen(utf16_t(filename), file::exists(filename) ? L"rb+" : L"wb");
+    #endif
+    if(!fp) return false;
+    bool result = fseek(fp, offset, SEEK_SET) == 0;
+    result &= fwrite(data.data(), 1, data.size(), fp) == data.size();
+    result &= fflush(fp) == 0;
+    #if defined(API_POSIX)
+    result &= ftruncate(fileno(fp), offset + data.size()) == 0;
+    result &= fsync(fileno(fp)) == 0;
+    #elif defined(API_WINDOWS)
+    result &= _chsize(_fileno(fp), offset + data.size()) == 0;
+    result &= _commit(_fileno(fp)) == 0;
+    #endif
+    return fclose(fp) == 0 && result;
+  }
+
+  //replaces the file as a whole: an interrupted write leaves the previous file in place
+  auto replace(const string& filename, const vector<uint8_t>& data) -> bool {
+    string temporary = {filename, ".tmp"};
+    if(!commit(temporary, 0, data)) return file::remove(temporary), false;
+    #if defined(API_WINDOWS)
+    file::remove(filename);
+    #endif
+    return file::rename(temporary, filename);
+  }
+}
+
+StateStore::~StateStore() {
+  close();
+}
+
+//switches to the states at the location: a folder ending in "/", or an archive
+auto StateStore::open(const string& location) -> void {
+  if(location == this->location) return;
+  close();
+  this->location = location;
+  if(!location) return;
+  if(!archive()) return scan();
+
+  auto memory = file::read(location);
+  if(!memory || parse(memory)) return;
+
+  //archives written by other tools may be compressed, or laid out differently: they are rewritten once
+  Decode::ZIP input;
+  if(!input.open(memory.data(), memory.size())) return;
+  vector<uint8_t> output;
+  for(auto& file : input.file) {
+    if(!file.name.endsWith(".bst")) continue;
+    auto data = input.extract(file);
+    Entry entry;
+    entry.name = string{file.name}.trimRight(".bst", 1L);
+    entry.date = entry.storedDate = file.timestamp;
+    entry.stored = true;
+    entry.header = output.size();
+    entry.size = data.size();
+    entry.checksum = Hash::CRC32(data).digest().hex();
+    writeHeader(output, file.name, entry.date, entry.checksum, entry.size);
+    output.append(data);
+    entries.append(entry);
+  }
+  auto directory = centralDirectory(entries, output.size());
+  output.append(directory);
+  if(!replace(location, output)) return entries.reset();
+  end = output.size();
+  tail = directory.size();
+}
+
+//finishes writing, and forgets the index
+auto StateStore::close() -> void {
+  flush();
+  { std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  changed.notify_all();
+  if(thread.joinable()) thread.join();
+  stopping = false;
+  location = {};
+  entries.reset();
+  end = tail = 0;
+  garbage = 0;
+}
+
+//waits for every queued state to be written
+auto StateStore::flush() -> void {
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [&] { return !jobs && !busy; });
+}
+
+//the last failure to write a state, reported once
+auto StateStore::failure() -> string {
+  std::lock_guard<std::mutex> lock(mutex);
+  string result = failed;
+  failed = {};
+  return result;
+}
+
+auto StateStore::states(const string& type) -> vector<Entry> {
+  std::lock_guard<std::mutex> lock(mutex);
+  vector<Entry> result;
+  for(auto& entry : entries) {
+    if(entry.name.beginsWith(type) && (entry.stored || entry.pending)) result.append(entry);
+  }
+  return result;
+}
+
+auto StateStore::exists(const string& name) -> bool {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto entry = find(name);
+  return entry && (entry->stored || entry->pending);
+}
+
+auto StateStore::read(const string& name) -> vector<uint8_t> {
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [&] { auto entry = find(name); return !entry || !entry->pending; });
+  auto entry = find(name);
+  if(!entry || !entry->stored) return {};
+  if(!archive()) return file::read({location, name, ".bst"});
+  return extract(*entry);
+}
+
+auto StateStore::write(const string& name, vector<uint8_t> state, Preview preview) -> void {
+  if(!location) return;
+  uint64_t date = chrono::timestamp();
+  { std::lock_guard<std::mutex> lock(mutex);
+    auto entry = find(name);
+    if(!entry) {
+      Entry created;
+      created.name = name;
+      entries.append(created);
+      entry = &entries.last();
+    }
+    entry->date = date;
+    entry->pending++;
+    Job job;
+    job.name = name;
+    job.date = date;
+    job.state = move(state);
+    job.preview = move(preview);
+    jobs.append(move(job));
+  }
+  if(!thread.joinable()) thread = std::thread([this] { worker(); });
+  changed.notify_all();
+}
+
+auto StateStore::remove(const string& name) -> bool {
+  flush();
+  auto entry = find(name);
+  if(!entry || !entry->stored) return false;
+
+  if(!archive()) {
+    if(!file::remove({location, name, ".bst"})) return false;
+    entries.removeByIndex(entry - entries.data());
+    return true;
+  }
+
+  garbage += 30 + name.size() + 4 + entry->size;
+  entries.removeByIndex(entry - entries.data());
+  if(!entries) {
+    //remove the archive if there are no states left in it
+    end = tail = 0;
+    garbage = 0;
+    return file::remove(location);
+  }
+  auto directory = centralDirectory(entries, end);
+  if(!commit(location, end, directory)) return false;
+  garbage += tail;
+  end += directory.size();
+  tail = directory.size();
+  if(garbage > end / 2) compact();
+  return true;
+}
+
+auto StateStore::rename(const string& from, const string& to) -> bool {
+  flush();
+  auto entry = find(from);
+  if(!entry || !entry->stored) return false;
+
+  if(!archive()) {
+    string filename = {location, to, ".bst"};
+    directory::create(Location::path(filename));
+    if(!file::rename({location, from, ".bst"}, filename)) return false;
+    entry->name = to;
+    return true;
+  }
+
+  //the name is also held by the local header, so the archive is rewritten
+  return compact(from, to);
+}
+
+auto StateStore::find(const string& name) -> Entry* {
+  for(auto& entry : entries) {
+    if(entry.name == name) return &entry;
+  }
+  return nullptr;
+}
+
+//indexes the .bst files in the folders of the state folder
+auto StateStore::scan() -> void {
+  for(auto& type : directory::ifolders(location)) {
+    for(auto& file : directory::ifiles({location, type}, "*.bst")) {
+      Entry entry;
+      entry.name = {type, string{file}.trimRight(".bst", 1L)};
+      entry.date = entry.storedDate = file::timestamp({location, type, file}, file::time::modify);
+      entry.stored = true;
+      entries.append(entry);
+    }
+  }
+}
+
+//indexes an archive laid out by the store; it may end with an interrupted write past its last directory
+auto StateStore::parse(const vector<uint8_t>& memory) -> bool {
+  auto data = memory.data();
+  for(int64_t footer = (int64_t)memory.size() - 22; footer >= 0; footer--) {
+    if(readl(data + footer, 4) != 0x06054b50) continue;
+    uint count = readl(data + footer + 10, 2);
+    uint32_t size = readl(data + footer + 12, 4);
+    uint32_t offset = readl(data + footer + 16, 4);
+    if((uint64_t)offset + size != footer || readl(data + footer + 20, 2)) continue;
+
+    vector<Entry> parsed;
+    uint64_t live = 0;
+    for(uint32_t record = offset; record < footer;) {
+      if(record + 46 > footer || readl(data + record, 4) != 0x02014b50) return false;
+      if(readl(data + record + 10, 2)) return false;  //compressed
+      uint length = readl(data + record + 28, 2);
+      if(readl(data + record + 30, 2) || readl(data + record + 32, 2)) return false;  //extra fields or comments
+      if(record + 46 + length > footer) return false;
+      string filename = string_view{(const char*)data + record + 46, length};
+      if(!filename.endsWith(".bst")) return false;
+
+      Entry entry;
+      entry.name = string{filename}.trimRight(".bst", 1L);
+      entry.date = entry.storedDate = unixTime(readl(data + record + 12, 2), readl(data + record + 14, 2));
+      entry.stored = true;
+      entry.checksum = readl(data + record + 16, 4);
+      entry.size = readl(data + record + 24, 4);
+      entry.header = readl(data + record + 42, 4);
+      if((uint64_t)entry.header + 30 + length + entry.size > offset) return false;
+      if(readl(data + entry.header, 4) != 0x04034b50 || readl(data + entry.header + 28, 2)) return false;
+      live += 30 + length + entry.size;
+      parsed.append(entry);
+      record += 46 + length;
+    }
+    if(parsed.size() != count) return false;
+
+    entries = parsed;
+    end = footer + 22;
+    tail = end - offset;
+    garbage = offset - live;
+    return true;
+  }
+  return false;
+}
+
+//the central directory of the stored states, and the end record that points to it
+auto StateStore::centralDirectory(const vector<Entry>& entries, uint32_t offset) -> vector<uint8_t> {
+  vector<uint8_t> output;
+  uint count = 0;
+  for(auto& entry : entries) {
+    if(!entry.stored) continue;
+    string filename = {entry.name, ".bst"};
+    writel(output, 0x02014b50, 4);       //signature
+    writel(output, 0x0014, 2);           //version made by (2.0)
+    writel(output, 0x0014, 2);           //version needed to extract (2.0)
+    writel(output, 0x0000, 2);           //general purpose bit flags
+    writel(output, 0x0000, 2);           //compression method (0 = uncompressed)
+    writel(output, dosTime(entry.storedDate), 2);
+    writel(output, dosDate(entry.storedDate), 2);
+    writel(output, entry.checksum, 4);
+    writel(output, entry.size, 4);       //compressed size
+    writel(output, entry.size, 4);       //uncompressed size
+    writel(output, filename.size(), 2);  //file name length
+    writel(output, 0x0000, 2);           //extra field length
+    writel(output, 0x0000, 2);           //file comment length
+    writel(output, 0x0000, 2);           //disk number start
+    writel(output, 0x0000, 2);           //internal file attributes
+    writel(output, 0x00000000, 4);       //external file attributes
+    writel(output, entry.header, 4);     //relative offset of file header
+    writes(output, filename);
+    count++;
+  }
+  uint32_t size = output.size();
+  writel(output, 0x06054b50, 4);         //signature
+  writel(output, 0x0000, 2);             //number of this disk
+  writel(output, 0x0000, 2);             //disk where central directory starts
+  writel(output, count, 2);              //number of central directory records on this disk
+  writel(output, count, 2);              //total number of central directory records
+  writel(output, size, 4);               //size of central directory
+  writel(output, offset, 4);             //offset of central directory
+  writel(output, 0x0000, 2);             //comment length
+  return output;
+}
+
+//rewrites the archive with only the stored states, renaming one of them if requested
+auto StateStore::compact(const string& from, const string& to) -> bool {
+  vector<Entry> stored;
+  { std::lock_guard<std::mutex> lock(mutex);
+    for(auto& entry : entries) {
+      if(entry.stored) stored.append(entry);
+    }
+  }
+
+  vector<uint8_t> output;
+  vector<string> names;
+  for(auto& entry : stored) {
+    auto data = extract(entry);
+    if(data.size() != entry.size) return false;
+    names.append(entry.name);
+    if(from && entry.name == from) entry.name = to;
+    entry.header = output.size();
+    writeHeader(output, {entry.name, ".bst"}, entry.storedDate, entry.checksum, entry.size);
+    output.append(data);
+  }
+  auto directory = centralDirectory(stored, output.size());
+  output.append(directory);
+  string temporary = {location, ".tmp"};
+  if(!commit(temporary, 0, output)) return file::remove(temporary), false;
+
+  //states may be read meanwhile: the archive is only swapped along with the index
+  std::lock_guard<std::mutex> lock(mutex);
+  #if defined(API_WINDOWS)
+  file::remove(location);
+  #endif
+  if(!file::rename(temporary, location)) return false;
+  for(uint n : range(stored.size())) {
+    if(auto entry = find(names[n])) {
+      entry->name = stored[n].name;
+      entry->header = stored[n].header;
+    }
+  }
+  end = output.size();
+  tail = directory.size();
+  garbage = 0;
+  return true;
+}
+
+auto StateStore::extract(const Entry& entry) -> vector<uint8_t> {
+  file_buffer fp;
+  if(!fp.open(location, file::mode::read)) return {};
+  fp.seek(entry.header + 26);
+  uint nameLength = fp.readl(2);
+  uint extraLength = fp.readl(2);
+  if(entry.header + 30 + nameLength + extraLength + entry.size > fp.size()) return {};
+  fp.seek(entry.header + 30 + nameLength + extraLength);
+  vector<uint8_t> data;
+  data.resize(entry.size);
+  fp.read({data.data(), data.size()});
+  if(Hash::CRC32(data).digest().hex() != entry.checksum) return {};
+  return data;
+}
+
+auto StateStore::worker() -> void {
+  std::unique_lock<std::mutex> lock(mutex);
+  while(true) {
+    changed.wait(lock, [&] { return jobs || stopping; });
+    if(!jobs) return;
+    auto job = jobs.takeFirst();
+    busy = true;
+    lock.unlock();
+    store(job);
+    lock.lock();
+    busy = false;
+    changed.notify_all();
+  }
+}
+
+//encodes and writes a state, on the worker thread
+auto StateStore::store(Job& job) -> void {
+  auto data = encode(job);
+
+  bool result = false;
+  if(!archive()) {
+    string filename = {location, job.name, ".bst"};
+    directory::create(Location::path(filename));
+    result = replace(filename, data);
+    std::lock_guard<std::mutex> lock(mutex);
+    if(auto entry = find(job.name); entry && result) {
+      entry->stored = true;
+      entry->storedDate = job.date;
+      entry->size = data.size();
+    }
+  } else {
+    result = append(job.name, job.date, data);
+    if(result && garbage > end / 2) compact();
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if(auto entry = find(job.name)) entry->pending--;
+  if(!result) failed = {"Unable to write [", Location::file(job.name), "] to disk"};
+}
+
+//the .bst format: a header, followed by the RLE-compressed state and preview image
+auto StateStore::encode(Job& job) -> vector<uint8_t> {
+  auto serializerRLE = Encode::RLE<1>({job.state.data(), job.state.size()});
+
+  vector<uint8_t> previewRLE;
+  if(auto& source = job.preview; source.pixels) {
+    image preview;
+    preview.transform(0, 15, 0x8000, 0x7c00, 0x03e0, 0x001f);
+    preview.copy(source.pixels.data(), source.width * sizeof(uint32_t), source.width, source.height);
+    if(preview.width() != 256 || preview.height() != 240) preview.scale(256, 240, true);
+    previewRLE = Encode::RLE<2>({preview.data(), preview.size()});
+  }
+
+  vector<uint8_t> saveState;
+  saveState.resize(3 * sizeof(uint));
+  memory::writel<sizeof(uint)>(saveState.data() + 0 * sizeof(uint), Program::State::Signature);
+  memory::writel<sizeof(uint)>(saveState.data() + 1 * sizeof(uint), serializerRLE.size());
+  memory::writel<sizeof(uint)>(saveState.data() + 2 * sizeof(uint), previewRLE.size());
+  saveState.append(serializerRLE);
+  saveState.append(previewRLE);
+  return saveState;
+}
+
+//writes a state past the end of the archive, followed by a new directory, on the worker thread
+auto StateStore::append(const string& name, uint64_t date, const vector<uint8_t>& data) -> bool {
+  string filename = {name, ".bst"};
+  uint32_t checksum = Hash::CRC32(data).digest().hex();
+
+  vector<uint8_t> output;
+  writeHeader(output, filename, date, checksum, data.size());
+  output.append(data);
+
+  Entry previous;
+  uint32_t directorySize = 0;
+  { std::lock_guard<std::mutex> lock(mutex);
+    auto entry = find(name);
+    if(!entry) return false;
+    previous = *entry;
+    entry->stored = true;
+    entry->storedDate = date;
+    entry->header = end;
+    entry->size = data.size();
+    entry->checksum = checksum;
+    auto directory = centralDirectory(entries, end + output.size());
+    directorySize = directory.size();
+    output.append(directory);
+  }
+
+  if(!commit(location, end, output)) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(auto entry = find(name)) {
+      entry->stored = previous.stored;
+      entry->storedDate = previous.storedDate;
+      entry->header = previous.header;
+      entry->size = previous.size;
+      entry->checksum = previous.checksum;
+    }
+    return false;
+  }
+
+  //the previous directory, and the previous state of the same name, are no longer referenced
+  garbage += tail;
+  if(previous.stored) garbage += 30 + filename.size() + previous.size;
+  end += output.size();
+  tail = directorySize;
+  return true;
+}
@@ -0,0 +1,78 @@
+//StateStore keeps the save states of the loaded game, indexed in memory:
+//either as one .bst file per state in the game folder, or as every state in one .bsz archive.
+//
+//the archive is a ZIP file that is only ever appended to: a new state is written past the end of the archive,
+//followed by a new central directory that supersedes the previous one, so that an interrupted write leaves
+//the previous archive readable. the space of replaced states is reclaimed once it outweighs the live states.
+//
+//saving a state only copies it: encoding it and writing it to disk happen on a background thread, in order.
+//reading a state that is still being written waits for it.
+
+struct StateStore {
+  struct Entry {
+    string name;           //without the .bst extension
+    uint64_t date = 0;     //of the latest save, pending or not
+    uint pending = 0;      //saves queued or being written
+
+    //where the stored state lies in the archive
+    bool stored = false;
+    uint64_t storedDate = 0;
+    uint32_t header = 0;   //offset of the local file header
+    uint32_t size = 0;
+    uint32_t checksum = 0;
+  };
+
+  struct Preview {
+    vector<uint32_t> pixels;  //15-bit colors
+    uint width = 0;
+    uint height = 0;
+  };
+
+  ~StateStore();
+
+  auto open(const string& location) -> void;
+  auto close() -> void;
+  auto flush() -> void;
+  auto failure() -> string;
+
+  auto states(const string& type) -> vector<Entry>;
+  auto exists(const string& name) -> bool;
+  auto read(const string& name) -> vector<uint8_t>;
+  auto write(const string& name, vector<uint8_t> state, Preview preview) -> void;
+  auto remove(const string& name) -> bool;
+  auto rename(const string& from, const string& to) -> bool;
+
+private:
+  struct Job {
+    string name;
+    uint64_t date = 0;
+    vector<uint8_t> state;
+    Preview preview;
+  };
+
+  auto archive() const -> bool { return !location.endsWith("/"); }
+  auto find(const string& name) -> Entry*;
+  auto scan() -> void;
+  auto parse(const vector<uint8_t>& memory) -> bool;
+  static auto centralDirectory(const vector<Entry>& entries, uint32_t offset) -> vector<uint8_t>;
+  auto compact(const string& from = {}, const string& to = {}) -> bool;
+  auto extract(const Entry& entry) -> vector<uint8_t>;
+  auto worker() -> void;
+  auto store(Job& job) -> void;
+  auto encode(Job& job) -> vector<uint8_t>;
+  auto append(const string& name, uint64_t date, const vector<uint8_t>& data) -> bool;
+
+  string location;        //a folder ending in "/", or an archive
+  vector<Entry> entries;
+  uint32_t end = 0;       //of the archive: new states are appended here
+  uint32_t tail = 0;      //size of the central directory and end record that the archive ends with
+  uint64_t garbage = 0;   //bytes of the archive no longer referenced
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::thread thread;
+  vector<Job> jobs;
+  bool busy = false;
+  bool stopping = false;
+  string failed;
+};
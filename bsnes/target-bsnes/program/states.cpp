@@ -4,54 +4,25 @@ auto Program::availableStates(string type) -> vector<State> {
   vector<State> result;
   if(!emulator->loaded()) return result;
 
-  if(gamePath().endsWith("/")) {
-    for(auto& file : directory::ifiles({statePath(), type}, "*.bst")) {
-      auto timestamp = file::timestamp({statePath(), type, file}, file::time::modify);
-      result.append({{type, file.trimRight(".bst", 1L)}, timestamp});
-    }
-  } else {
-    Decode::ZIP input;
-    if(input.open(statePath())) {
-      for(auto& file : input.file) {
-        if(!file.name.match({type, "*.bst"})) continue;
-        result.append({file.name.trimRight(".bst", 1L), (uint64_t)file.timestamp});
-      }
-    }
+  stateStore.open(statePath());
+  for(auto& entry : stateStore.states(type)) {
+    result.append({entry.name, entry.date});
   }
-
   return result;
 }
 
 auto Program::hasState(string filename) -> bool {
   if(!emulator->loaded()) return false;
 
-  if(gamePath().endsWith("/")) {
-    return file::exists({statePath(), filename, ".bst"});
-  } else {
-    auto type = string{filename.split("/").first(), "/"};
-    return (bool)availableStates(type).find([&](auto& state) { return state.name == filename; });
-  }
+  stateStore.open(statePath());
+  return stateStore.exists(filename);
 }
 
 auto Program::loadStateData(string filename) -> vector<uint8_t> {
   if(!emulator->loaded()) return {};
 
-  vector<uint8_t> memory;
-  if(gamePath().endsWith("/")) {
-    string location = {statePath(), filename, ".bst"};
-    memory = file::read(location);
-  } else {
-    string location = {filename, ".bst"};
-    Decode::ZIP input;
-    if(input.open(statePath())) {
-      for(auto& file : input.file) {
-        if(file.name != location) continue;
-        memory = input.extract(file);
-        break;
-      }
-    }
-  }
-
+  stateStore.open(statePath());
+  auto memory = stateStore.read(filename);
   if(memory.size() < 3 * sizeof(uint)) return {};  //too small to be a valid state file
   if(memory::readl<sizeof(uint)>(memory.data()) != State::Signature) return {};  //wrong format or version
   return memory;
@@ -78,55 +49,26 @@ auto Program::saveState(string filename) -> bool {
 
   serializer s = emulator->serialize();
   if(!s.size()) return showMessage({"Failed to save [", prefix, "]"}), false;
-  auto serializerRLE = Encode::RLE<1>({s.data(), s.size()});
+  vector<uint8_t> state;
+  state.resize(s.size());
+  memory::copy(state.data(), s.data(), s.size());
 
-  vector<uint8_t> previewRLE;
+  //the state and preview are only copied here: they are encoded and written by the state store
+  StateStore::Preview preview;
   //this can be null if a state is captured before the first frame of video output after power/reset
   if(screenshot.data) {
-    image preview;
-    preview.transform(0, 15, 0x8000, 0x7c00, 0x03e0, 0x001f);
-    preview.copy(screenshot.data, screenshot.pitch, screenshot.width, screenshot.height);
-    if(preview.width() != 256 || preview.height() != 240) preview.scale(256, 240, true);
-    previewRLE = Encode::RLE<2>({preview.data(), preview.size()});
-  }
-
-  vector<uint8_t> saveState;
-  saveState.resize(3 * sizeof(uint));
-  memory::writel<sizeof(uint)>(saveState.data() + 0 * sizeof(uint), State::Signature);
-  memory::writel<sizeof(uint)>(saveState.data() + 1 * sizeof(uint), serializerRLE.size());
-  memory::writel<sizeof(uint)>(saveState.data() + 2 * sizeof(uint), previewRLE.size());
-  saveState.append(serializerRLE);
-  saveState.append(previewRLE);
-
-  if(gamePath().endsWith("/")) {
-    string location = {statePath(), filename, ".bst"};
-    directory::create(Location::path(location));
-    if(!file::write(location, saveState)) {
-      return showMessage({"Unable to write [", prefix, "] to disk"}), false;
-    }
-  } else {
-    string location = {filename, ".bst"};
-
-    struct State { string name; time_t timestamp; vector<uint8_t> memory; };
-    vector<State> states;
-
-    Decode::ZIP input;
-    if(input.open(statePath())) {
-      for(auto& file : input.file) {
-        if(!file.name.endsWith(".bst")) continue;
-        if(file.name == location) continue;
-        states.append({file.name, file.timestamp, input.extract(file)});
-      }
-    }
-    input.close();
-
-    Encode::ZIP output{statePath()};
-    for(auto& state : states) {
-      output.append(state.name, state.memory.data(), state.memory.size(), state.timestamp);
+    preview.width = screenshot.width;
+    preview.height = screenshot.height;
+    preview.pixels.resize(screenshot.width * screenshot.height);
+    for(uint y : range(screenshot.height)) {
+      auto line = (const uint8_t*)screenshot.data + y * screenshot.pitch;
+      memory::copy(preview.pixels.data() + y * screenshot.width, line, screenshot.width * sizeof(uint32_t));
     }
-    output.append(location, saveState.data(), saveState.size());
   }
 
+  stateStore.open(statePath());
+  stateStore.write(filename, move(state), move(preview));
+
   if(filename.beginsWith("Quick/")) presentation.updateStateMenus();
   stateManager.stateEvent(filename);
   return showMessage({"Saved [", prefix, "]"}), true;
@@ -152,40 +94,9 @@ auto Program::saveRedoState() -> bool {
 
 auto Program::removeState(string filename) -> bool {
   if(!emulator->loaded()) return false;
-  bool result = false;
-
-  if(gamePath().endsWith("/")) {
-    string location = {statePath(), filename, ".bst"};
-    result = file::remove(location);
-  } else {
-    bool found = false;
-    string location = {filename, ".bst"};
-
-    struct State { string name; time_t timestamp; vector<uint8_t> memory; };
-    vector<State> states;
-
-    Decode::ZIP input;
-    if(input.open(statePath())) {
-      for(auto& file : input.file) {
-        if(file.name == location) { found = true; continue; }
-        states.append({file.name, file.timestamp, input.extract(file)});
-      }
-    }
-    input.close();
-
-    if(states) {
-      Encode::ZIP output{statePath()};
-      for(auto& state : states) {
-        output.append(state.name, state.memory.data(), state.memory.size(), state.timestamp);
-      }
-    } else {
-      //remove .bsz file if there are no states left in the archive
-      file::remove(statePath());
-    }
-
-    result = found;
-  }
 
+  stateStore.open(statePath());
+  bool result = stateStore.remove(filename);
   if(result) {
     presentation.updateStateMenus();
     stateManager.stateEvent(filename);
@@ -193,41 +104,13 @@ auto Program::removeState(string filename) -> bool {
   return result;
 }
 
-auto Program::renameState(string from_, string to_) -> bool {
+auto Program::renameState(string from, string to) -> bool {
   if(!emulator->loaded()) return false;
-  bool result = false;
-
-  if(gamePath().endsWith("/")) {
-    string from = {statePath(), from_, ".bst"};
-    string to = {statePath(), to_, ".bst"};
-    result = file::rename(from, to);
-  } else {
-    bool found = false;
-    string from = {from_, ".bst"};
-    string to = {to_, ".bst"};
-
-    struct State { string name; time_t timestamp; vector<uint8_t> memory; };
-    vector<State> states;
-
-    Decode::ZIP input;
-    if(input.open(statePath())) {
-      for(auto& file : input.file) {
-        if(file.name == from) { found = true; file.name = to; }
-        states.append({file.name, file.timestamp, input.extract(file)});
-      }
-    }
-    input.close();
-
-    Encode::ZIP output{statePath()};
-    for(auto& state : states) {
-      output.append(state.name, state.memory.data(), state.memory.size(), state.timestamp);
-    }
-
-    result = found;
-  }
 
+  stateStore.open(statePath());
+  bool result = stateStore.rename(from, to);
   if(result) {
-    stateManager.stateEvent(to_);
+    stateManager.stateEvent(to);
   }
   return result;
 }
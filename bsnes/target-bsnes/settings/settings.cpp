@@ -107,6 +107,7 @@ auto Settings::process(bool load) -> void {
 
   bind(natural, "Rewind/Frequency", rewind.frequency);
   bind(natural, "Rewind/Length",    rewind.length);
+  bind(natural, "Rewind/Memory",    rewind.memory);
   bind(boolean, "Rewind/Mute",      rewind.mute);
 
   bind(boolean, "Emulator/WarnOnUnverifiedGames",        emulator.warnOnUnverifiedGames);
@@ -124,6 +125,9 @@ auto Settings::process(bool load) -> void {
   bind(boolean, "Emulator/Hack/PPU/Deinterlace",         emulator.hack.ppu.deinterlace);
   bind(boolean, "Emulator/Hack/PPU/NoSpriteLimit",       emulator.hack.ppu.noSpriteLimit);
   bind(boolean, "Emulator/Hack/PPU/NoVRAMBlocking",      emulator.hack.ppu.noVRAMBlocking);
+  bind(natural, "Emulator/Hack/PPU/RenderThreads",       emulator.hack.ppu.renderThreads);
+  bind(boolean, "Emulator/Hack/PPU/RenderPipeline",      emulator.hack.ppu.renderPipeline);
+  bind(boolean, "Emulator/Hack/PPU/RenderIncremental",   emulator.hack.ppu.renderIncremental);
   bind(natural, "Emulator/Hack/PPU/Mode7/Scale",         emulator.hack.ppu.mode7.scale);
   bind(natural, "Emulator/Hack/PPU/Mode7/Perspective",   emulator.hack.ppu.mode7.perspective);
   bind(natural, "Emulator/Hack/PPU/Mode7/Widescreen",    emulator.hack.ppu.mode7.widescreen);
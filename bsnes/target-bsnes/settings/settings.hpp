@@ -83,6 +83,7 @@ struct Settings : Markup::Node {
   struct Rewind {
     uint frequency = 0;
     uint length = 80;
+    uint memory = 64;  //MiB
     bool mute = false;
   } rewind;
 
@@ -112,6 +113,9 @@ struct Settings : Markup::Node {
         bool deinterlace = true;
         bool noSpriteLimit = true;
         bool noVRAMBlocking = false;
+        uint renderThreads = 0;
+        bool renderPipeline = false;
+        bool renderIncremental = false;
         struct Mode7 {
           uint scale = 2;
           uint perspective = 1;
@@ -340,6 +344,8 @@ public:
     ComboButton rewindFrequencyOption{&rewindLayout, Size{0, 0}};
     Label rewindLengthLabel{&rewindLayout, Size{0, 0}};
     ComboButton rewindLengthOption{&rewindLayout, Size{0, 0}};
+    Label rewindMemoryLabel{&rewindLayout, Size{0, 0}};
+    ComboButton rewindMemoryOption{&rewindLayout, Size{0, 0}};
   CheckLabel rewindMute{this, Size{0, 0}};
 };
 
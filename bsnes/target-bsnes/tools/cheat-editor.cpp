@@ -20,11 +20,9 @@ auto CheatDatabase::findCheats() -> void {
   auto sha256a = emulator->hashes()(0, "none");
   auto sha256b = emulator->hashes()(1, "none");
 
-  auto document = BML::unserialize(string::read(locate("Database/Cheat Codes.bml")));
-  for(auto game : document.find("cartridge")) {
-    if(game["sha256"].text() != sha256a
-    && game["sha256"].text() != sha256b) continue;
-
+  auto entry = program.databaseFind("Cheat Codes", "cartridge", sha256a);
+  if(!entry) entry = program.databaseFind("Cheat Codes", "cartridge", sha256b);
+  if(auto game = BML::unserialize(entry)["cartridge"]) {
     cheatList.reset();
     for(auto cheat : game.find("cheat")) {
       //convert old cheat format (address/data and address/compare/data)
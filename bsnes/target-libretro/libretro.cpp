@@ -222,6 +222,37 @@ static bool update_variables() // returns whether video dimensions have changed
 			emulator->configure("Hacks/PPU/NoVRAMBlocking", false);
 	}
 
+	var.key = "bsnes_ppu_render_threads";
+	var.value = NULL;
+
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+	{
+		int val = atoi(var.value);
+		emulator->configure("Hacks/PPU/RenderThreads", val);
+	}
+
+	var.key = "bsnes_ppu_render_pipeline";
+	var.value = NULL;
+
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+	{
+		if (strcmp(var.value, "ON") == 0)
+			emulator->configure("Hacks/PPU/RenderPipeline", true);
+		else if (strcmp(var.value, "OFF") == 0)
+			emulator->configure("Hacks/PPU/RenderPipeline", false);
+	}
+
+	var.key = "bsnes_ppu_render_incremental";
+	var.value = NULL;
+
+	if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var))
+	{
+		if (strcmp(var.value, "ON") == 0)
+			emulator->configure("Hacks/PPU/RenderIncremental", true);
+		else if (strcmp(var.value, "OFF") == 0)
+			emulator->configure("Hacks/PPU/RenderIncremental", false);
+	}
+
 	var.key = "bsnes_dsp_fast";
 	var.value = NULL;
 
@@ -938,20 +969,37 @@ void retro_reset()
 	emulator->reset();
 }
 
+// run-ahead state is kept alive between frames; after the first full snapshot,
+// only memory pages written since the last save or load are transferred
+static serializer run_ahead_state;
+static bool run_ahead_valid = false;
+
+static void run_ahead_reset()
+{
+	run_ahead_state = {};
+	run_ahead_valid = false;
+	emulator->trackDirtyPages(false);
+}
+
 static void run_with_runahead(const int frames)
 {
 	assert(frames > 0);
 
 	emulator->setRunAhead(true);
 	emulator->run();
-	auto state = emulator->serialize(0);
+	if (!run_ahead_valid || !emulator->serialize(run_ahead_state, false, true)) {
+		run_ahead_state = emulator->serialize(0);
+		run_ahead_valid = true;
+		emulator->trackDirtyPages(true);
+	}
 	for (int i = 0; i < frames - 1; ++i) {
 		emulator->run();
 	}
 	emulator->setRunAhead(false);
 	emulator->run();
-	state.setMode(serializer::Mode::Load);
-	emulator->unserialize(state);
+	run_ahead_state.setMode(serializer::Mode::Load);
+	if (!emulator->unserialize(run_ahead_state, true))
+		run_ahead_reset();
 }
 
 void retro_run()
@@ -975,18 +1023,19 @@ void retro_run()
 
 size_t retro_serialize_size()
 {
-	return emulator->serialize().size();
+	return emulator->serializeSize();
 }
 
+// states are written to and read from the frontend's buffer directly
 bool retro_serialize(void *data, size_t size)
 {
-	memcpy(data, emulator->serialize().data(), size);
-	return true;
+	serializer s(static_cast<uint8_t *>(data), size, serializer::Mode::Save);
+	return emulator->serialize(s, true, false);
 }
 
 bool retro_unserialize(const void *data, size_t size)
 {
-	serializer s(static_cast<const uint8_t *>(data), size);
+	serializer s(static_cast<uint8_t *>(const_cast<void *>(data)), size, serializer::Mode::Load);
 	return emulator->unserialize(s);
 }
 
@@ -1133,6 +1182,7 @@ void retro_unload_game()
 {
 	program->save();
 	emulator->unload();
+	run_ahead_reset();
 }
 
 unsigned retro_get_region()
@@ -414,6 +414,46 @@ struct retro_core_option_definition option_defs_us[] = {
       },
       "OFF"
    },
+   {
+      "bsnes_ppu_render_threads",
+      "PPU (Video) - Render Threads",
+      "Number of threads the fast PPU renders scanlines with. 'Auto' uses one thread per CPU core. Higher HD Mode 7 scales benefit the most from additional threads.",
+      {
+         { "0",  "Auto" },
+         { "1",  NULL },
+         { "2",  NULL },
+         { "3",  NULL },
+         { "4",  NULL },
+         { "6",  NULL },
+         { "8",  NULL },
+         { "12", NULL },
+         { "16", NULL },
+         { NULL, NULL },
+      },
+      "0"
+   },
+   {
+      "bsnes_ppu_render_pipeline",
+      "PPU (Video) - Pipelined Rendering",
+      "Renders each frame on the render threads while the next frame is being emulated. This improves speed on multi-core CPUs at the cost of one frame of additional input latency. Has no effect when only one render thread is used.",
+      {
+         { "ON",  "enabled"  },
+         { "OFF", "disabled" },
+         { NULL, NULL },
+      },
+      "OFF"
+   },
+   {
+      "bsnes_ppu_render_incremental",
+      "PPU (Video) - Incremental Rendering",
+      "Renders scanlines on the render threads while the rest of the frame is still being emulated, instead of all at once at the end of the frame. This evens out frame times without adding latency. Mode 7 scanlines are still rendered at the end of the frame. Has no effect when only one render thread is used, or when pipelined rendering is enabled.",
+      {
+         { "ON",  "enabled"  },
+         { "OFF", "disabled" },
+         { NULL, NULL },
+      },
+      "OFF"
+   },
    {
       "bsnes_dsp_fast",
       "DSP (Audio) - Fast Mode",
@@ -29,8 +29,10 @@ struct Program : Emulator::Platform
 	
 	auto open(uint id, string name, vfs::file::mode mode, bool required) -> shared_pointer<vfs::file> override;
 	auto load(uint id, string name, string type, vector<string> options = {}) -> Emulator::Platform::Load override;
+	auto videoTarget(uint width, uint height, uint scale) -> Emulator::Platform::VideoTarget override;
 	auto videoFrame(const uint32* data, uint pitch, uint width, uint height, uint scale) -> void override;
 	auto audioFrame(const double* samples, uint channels) -> void override;
+	auto audioFrames(const double* samples, uint channels, uint frames) -> void override;
 	auto inputPoll(uint port, uint device, uint input) -> int16 override;
 	auto inputRumble(uint port, uint device, uint input, bool enable) -> void override;
 	
@@ -61,6 +63,13 @@ struct Program : Emulator::Platform
 	uint scale = 1;
 	bool ipsHeadered = false;
 
+	struct Framebuffer {
+		uint32* data = nullptr;
+		uint width = 0;
+		uint height = 0;
+		uint pitch = 0;
+	} framebuffer;
+
 public:	
 	struct Game {
 		explicit operator bool() const { return (bool)location; }
@@ -168,6 +177,7 @@ auto Program::open(uint id, string name, vfs::file::mode mode, bool required) ->
 }
 
 auto Program::load() -> void {
+	auto timeStart = chrono::nanosecond();
 	emulator->unload();
 	emulator->load();
 
@@ -234,6 +244,13 @@ auto Program::load() -> void {
 	Program::applySettingOverrides();
 
 	emulator->power();
+
+	if (libretro_print)
+	{
+		auto loadTime = chrono::nanosecond() - timeStart;
+		libretro_print(RETRO_LOG_INFO, "Loaded in %.3f ms, of which %.3f ms building the memory map\n",
+			loadTime / 1000000.0, emulator->memoryMapTime() / 1000000.0);
+	}
 }
 
 auto Program::applySettingOverrides() -> void {
@@ -385,8 +402,34 @@ auto Program::load(uint id, string name, string type, vector<string> options) ->
 	return { id, options(0) };
 }
 
+//lends the frontend's framebuffer to the PPU, which then renders the visible rows of the frame into it
+auto Program::videoTarget(uint width, uint height, uint scale) -> Emulator::Platform::VideoTarget {
+	framebuffer = {};
+	uint offset = overscan ? 8 : 12;
+	uint multiplier = height / 215;
+	uint rows = height - offset * 2 * multiplier;
+
+	retro_framebuffer fb = {};
+	fb.width = width;
+	fb.height = rows;
+	fb.access_flags = RETRO_MEMORY_ACCESS_WRITE;
+	if (!environ_cb || !environ_cb(RETRO_ENVIRONMENT_GET_CURRENT_SOFTWARE_FRAMEBUFFER, &fb)) return {};
+	if (!fb.data || fb.format != RETRO_PIXEL_FORMAT_XRGB8888 || fb.pitch % 4) return {};
+	if (fb.width < width || fb.height < rows || fb.pitch / 4 < width) return {};
+
+	framebuffer = {(uint32*)fb.data, width, rows, (uint)fb.pitch};
+	return {framebuffer.data, framebuffer.pitch / 4, offset * multiplier, rows};
+}
+
 auto Program::videoFrame(const uint32* data, uint pitch, uint width, uint height, uint scale) -> void {
 
+	if (framebuffer.data && data == framebuffer.data) {
+		//already cropped: only the visible rows were rendered into the frontend's framebuffer
+		video_cb(data, framebuffer.width, framebuffer.height, framebuffer.pitch);
+		framebuffer = {};
+		return;
+	}
+
 	uint offset = overscan ? 8 : 12;
 	uint multiplier = height / 215;
 	data   += offset * (pitch >> 2) * multiplier;
@@ -414,6 +457,21 @@ auto Program::audioFrame(const double* samples, uint channels) -> void
 	audio_queue(left, right);
 }
 
+auto Program::audioFrames(const double* samples, uint channels, uint frames) -> void
+{
+	for (uint frame = 0; frame < frames; frame++, samples += channels)
+	{
+		audio_buffer[audio_buffer_index++] = d2i16(samples[0]);
+		audio_buffer[audio_buffer_index++] = d2i16(samples[1]);
+
+		if (audio_buffer_index == audio_buffer_max)
+		{
+			audio_batch_cb(audio_buffer, audio_buffer_max/2);
+			audio_buffer_index = 0;
+		}
+	}
+}
+
 auto pollInputDevices(uint port, uint device, uint input) -> int16
 {
 	// TODO: This will need to be remapped on a per-system basis.
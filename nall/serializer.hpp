@@ -128,6 +128,14 @@ struct serializer {
     return array(data, N);
   }
 
+  //returns the next size bytes of the buffer and advances past them without transferring anything.
+  //used to patch a previously saved state in place; returns nullptr in Size mode.
+  auto span(uint size) -> uint8_t* {
+    auto data = _mode != Size ? _data + _size : nullptr;
+    _size += size;
+    return data;
+  }
+
   //nall/serializer saves data in little-endian ordering
   #if defined(ENDIAN_LSB)
   auto array(uint16_t* data, uint size) -> serializer& { return array((uint8_t*)data, size * sizeof(uint16_t)); }
@@ -145,10 +153,11 @@ struct serializer {
   template<typename T> auto operator()(T& value, uint size, typename std::enable_if<std::is_pointer<T>::value>::type* = 0) -> serializer& { return array(value, size); }
 
   auto operator=(const serializer& s) -> serializer& {
-    if(_data) delete[] _data;
+    if(_data && _owner) delete[] _data;
 
     _mode = s._mode;
     _data = new uint8_t[s._capacity];
+    _owner = true;
     _size = s._size;
     _capacity = s._capacity;
 
@@ -157,10 +166,11 @@ struct serializer {
   }
 
   auto operator=(serializer&& s) -> serializer& {
-    if(_data) delete[] _data;
+    if(_data && _owner) delete[] _data;
 
     _mode = s._mode;
     _data = s._data;
+    _owner = s._owner;
     _size = s._size;
     _capacity = s._capacity;
 
@@ -187,13 +197,23 @@ struct serializer {
     memcpy(_data, data, capacity);
   }
 
+  //operates directly on an external buffer, which must outlive the serializer
+  serializer(uint8_t* data, uint capacity, Mode mode) {
+    _mode = mode;
+    _data = data;
+    _owner = false;
+    _size = 0;
+    _capacity = capacity;
+  }
+
   ~serializer() {
-    if(_data) delete[] _data;
+    if(_data && _owner) delete[] _data;
   }
 
 private:
   Mode _mode = Size;
   uint8_t* _data = nullptr;
+  bool _owner = true;
   uint _size = 0;
   uint _capacity = 0;
 };
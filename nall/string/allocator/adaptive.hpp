@@ -97,7 +97,7 @@ auto string::_allocate() -> void {
   char _temp[SSO];
   memory::copy(_temp, _text, SSO);
   _data = memory::allocate<char>(_capacity + 1 + sizeof(uint));
-  memory::copy(_data, _temp, SSO);
+  memory::copy(_data, _capacity + 1, _temp, SSO);
   _refs = (uint*)(_data + _capacity + 1);  //always aligned by 32 via reserve()
   *_refs = 1;
 }